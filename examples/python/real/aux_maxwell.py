@@ -96,7 +96,7 @@ h1smat = petsc.PETScMatrix(h1scal_blf.mat, H1s.FreeDofs())
 #                                                     #"ksp_monitor" : "",
 #                                                     #"ksp_converged_reason" : "",
 #                                                     "pc_type" : "gamg"})
-pc_h1s = petsc.PETSc2NGsPrecond(h1smat, "h1spc", petsc_options={"pc_type" : "gamg"})
+pc_h1s = petsc.PETSc2NGsPrecond(h1smat, "h1spc", petsc_options={"pc_type" : "gamg"}, fes=H1s) # coordinates for GAMG
 
 
 ## H1 vector problem
@@ -0,0 +1,50 @@
+from ngsolve import *
+import ngs_petsc as petsc
+from netgen.meshing import Mesh as NGMesh
+from time import time
+
+# compares the bulk CSR conversion of NGSolve- to PETSc matrices with inserting block by block,
+# and with the chunked conversion under a memory budget
+
+comm = mpi_world
+
+if comm.rank==0:
+    from netgen.csg import unit_cube
+    ngm = unit_cube.GenerateMesh(maxh=0.1)
+    if comm.size > 1:
+        ngm.Distribute(comm)
+else:
+    ngm = NGMesh.Receive(comm)
+mesh = Mesh(ngm)
+
+petsc.Initialize()
+
+def make_mat(fes, symmetric):
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=symmetric)
+    a += InnerProduct(grad(u), grad(v)) * dx
+    a.Assemble()
+    return a.mat
+
+def time_conversion(mat, freedofs, bulk, mem_budget=0, nrep=3):
+    t = -time()
+    for k in range(nrep):
+        pmat = petsc.PETScMatrix(mat, freedofs=freedofs, bulk_csr=bulk, mem_budget=mem_budget)
+    t += time()
+    return t / nrep
+
+for fes in [H1(mesh, order=3, dirichlet=".*"), H1(mesh, order=2, dim=3, dirichlet=".*")]:
+    for symmetric in [False, True]:
+        mat = make_mat(fes, symmetric)
+        t_ent = time_conversion(mat, fes.FreeDofs(), bulk=False)
+        t_bulk = time_conversion(mat, fes.FreeDofs(), bulk=True)
+        t_chunk = time_conversion(mat, fes.FreeDofs(), bulk=True, mem_budget=8*1024*1024)
+        if comm.rank == 0:
+            print('---------------------------')
+            print('ndof = ', fes.ndofglobal, ', entry size = ', fes.dim, ', symmetric = ', symmetric)
+            print('t convert, block by block = ', t_ent)
+            print('t convert, bulk CSR       = ', t_bulk)
+            print('t convert, 8MB chunks     = ', t_chunk)
+            print('speedup = ', t_ent / t_bulk)
+
+petsc.Finalize()
@@ -38,33 +38,13 @@ gfu = GridFunction(V)
 
 a.Assemble()
 
-def rb_modes(fes):
-    dim = fes.mesh.dim
-    if dim == 3:
-        RBMS = [(1,0,0), (0,1,0), (0,0,1),
-                (y,-x,0), (0,z,-y), (-z, 0, x)]
-    else:
-        RBMS = [(1,0), (0,1), (y,-x)]
-    gfu = GridFunction(fes)
-    rbm_vecs = list()
-    upart = gfu
-    for RBM in RBMS:
-        if dim==3:
-            ucf = CoefficientFunction((RBM[0], RBM[1], RBM[2]))
-        else:
-            ucf = CoefficientFunction((RBM[0], RBM[1]))
-        upart.Set(ucf)
-        v = gfu.vec.CreateVector()
-        v.data = gfu.vec
-        rbm_vecs.append(v)
-    return rbm_vecs
-
 petsc.Initialize()
 
 mat_wrap = petsc.PETScMatrix(a.mat, freedofs=V.FreeDofs(), format=petsc.PETScMatrix.AIJ)
 opts = {"ksp_type":"cg", "ksp_atol":1e-30, "ksp_rtol":1e-8, "pc_type":"gamg"}
 ksp = petsc.KSP(mat=mat_wrap, name="someksp", petsc_options=opts, finalize=False)
-ksp.GetMatrix().SetNearNullSpace(rb_modes(V))
+# rigid body modes, computed from the vertex coordinates of V
+ksp.GetMatrix().SetNearNullSpace(fes=V)
 
 # import ngs_amg
 # mat_wrap = petsc.FlatPETScMatrix(a.mat, freedofs=V.FreeDofs())
@@ -0,0 +1,53 @@
+from ngsolve import *
+import ngs_petsc as petsc
+from netgen.meshing import Mesh as NGMesh
+from time import time
+
+# inner CG with a float copy of the matrix, wrapped in double precision iterative refinement
+
+comm = mpi_world
+
+if comm.rank==0:
+    from netgen.csg import unit_cube
+    ngm = unit_cube.GenerateMesh(maxh=0.05)
+    if comm.size>1:
+        ngm.Distribute(comm)
+else:
+    ngm = NGMesh.Receive(comm)
+mesh = Mesh(ngm)
+
+V = H1(mesh, order=2, dirichlet='.*')
+u,v = V.TnT()
+a = BilinearForm(V)
+a += InnerProduct(grad(u),grad(v)) * dx
+a.Assemble()
+f = LinearForm(V)
+f += v * dx
+f.Assemble()
+gfu = GridFunction(V)
+
+petsc.Initialize()
+
+mat_double = petsc.PETScMatrix(a.mat, freedofs=V.FreeDofs())
+mat_float = petsc.FloatPETScMatrix(a.mat, freedofs=V.FreeDofs())
+
+# the inner solve only has to reduce the residual by a few orders of magnitude
+opts = {"ksp_type" : "cg", "ksp_rtol" : 1e-5, "pc_type" : "jacobi"}
+ksp = petsc.KSP(mat=mat_float, name="inner_ksp", petsc_options=opts)
+
+solver = petsc.IterativeRefinement(mat=mat_double, ksp=ksp, rtol=1e-10)
+
+t = -time()
+gfu.vec.data = solver * f.vec
+t += time()
+
+res = solver.results
+if comm.rank==0:
+    print('ndof ', V.ndofglobal)
+    print('refinement steps: ', res['nits'])
+    print('residuals: ', res['errs'])
+    if res['diverged']:
+        print('inner KSP diverged: ', res['inner_conv_r'])
+    print('t solve: ', t)
+
+petsc.Finalize()
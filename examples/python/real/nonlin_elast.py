@@ -73,7 +73,12 @@ petsc_options = {"pc_type" : "none",
                  "snes_max_it" : 50,
                  "snes_linesearch_type" : "basic" }
 snes = petsc.SNES(a, name="mysnes", petsc_options=petsc_options, mode = petsc.SNES.JACOBI_MAT_MODE.FLAT)
+# matrix-free jacobian (APPLY or MFFD), with the PC built from the linearization of a cheaper form:
+# snes = petsc.SNES(a, name="mysnes", petsc_options=petsc_options, mode = petsc.SNES.JACOBI_MAT_MODE.MFFD, pc_blf = a_pc)
 snes_ksp = snes.GetKSP()
+# fused=True in the constructor computes residual and jacobian in the same loop over the elements
+# re-assemble the jacobian only every 2nd, rebuild the PC only every 4th Newton step
+# snes.SetLagging(jac_lag=2, pc_lag=4)
 
 res1 = gfu.vec.CreateVector()
 res2 = gfu.vec.CreateVector()
@@ -139,7 +144,10 @@ for loadstep in range(50):
     Redraw()
 
     ksp_res = snes_ksp.results
+    snes_res = snes.results
     if comm.rank==0:
+        print(' newton steps: ', snes_res['nits'], ', jacobian assembled: ', sum(snes_res['jac_assembled']))
+        print(' t jacobian: ', sum(snes_res['t_jac']), ', t setup: ', sum(snes_res['t_setup']))
     #     # print(' ----- ')
     #     # for k,v in ksp_res.items():
     #     #     print(k, v)
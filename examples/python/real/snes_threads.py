@@ -0,0 +1,76 @@
+from ngsolve import *
+import ngs_petsc as petsc
+from netgen.meshing import Mesh as NGMesh
+from time import time
+
+# Measures how the element loops in petsc.SNES (residual, linearization) behave with the number of threads.
+# Run with one rank per node (or socket), e.g.
+#     mpirun -n 1 python3 snes_threads.py
+# The residual and jacobian evaluations run in the NGSolve TaskManager, the LocalHeap is split
+# among the threads and grows automatically (see snes.heap_size). "t_jac" and the total minus
+# t_jac - t_setup (mostly residual evaluations) are the parts that run threaded, the KSP part
+# depends on the PC. How far they go down with more threads depends on the machine (these loops
+# are often memory bound); no reference numbers are given here.
+# At the end, a table with the speedup and parallel efficiency of the jacobian evaluations and of
+# the whole solve relative to one thread is printed; record it together with the machine
+# (cores, sockets, memory channels) when comparing versions.
+
+comm = mpi_world
+
+if comm.rank==0:
+    from netgen.csg import unit_cube
+    ngm = unit_cube.GenerateMesh(maxh=0.1)
+    if comm.size>1:
+        ngm.Distribute(comm)
+else:
+    ngm = NGMesh.Receive(comm)
+mesh = Mesh(ngm)
+
+E, nu = 210, 0.2
+mu  = E / 2 / (1+nu)
+lam = E * nu / ((1+nu)*(1-2*nu))
+
+V = VectorH1(mesh, order=3, dirichlet="back")
+u = V.TrialFunction()
+
+def NeoHook (C):
+    return 0.5 * mu * (Trace(C-I) + 2*mu/lam * Det(C)**(-lam/2/mu) - 1)
+
+I = Id(mesh.dim)
+F = I + Grad(u)
+C = F.trans * F
+
+a = BilinearForm(V, symmetric=False)
+a += Variation( NeoHook(C).Compile() * dx )
+a += Variation( -InnerProduct(CoefficientFunction((0,0,-0.5)), u) * dx )
+
+petsc.Initialize()
+
+petsc_options = {"ksp_type" : "gmres",
+                 "ksp_rtol" : 1e-6,
+                 "pc_type" : "gamg",
+                 "snes_rtol" : 1e-8,
+                 "snes_linesearch_type" : "bt" }
+
+gfu = GridFunction(V)
+timings = []
+for nthreads in [1, 2, 4, 8, 16]:
+    SetNumThreads(nthreads)
+    snes = petsc.SNES(a, name="snes_threads", petsc_options=petsc_options, mode=petsc.SNES.JACOBI_MAT_MODE.CONVERT)
+    gfu.vec[:] = 0
+    t = -time()
+    snes.Solve(gfu.vec)
+    t += time()
+    res = snes.results
+    if comm.rank==0:
+        print('threads ', nthreads, ', newton steps ', res['nits'], ', heap per thread ', snes.heap_size)
+        print('   t total ', t, ', t jacobian ', sum(res['t_jac']), ', t setup ', sum(res['t_setup']))
+    timings.append((nthreads, t, sum(res['t_jac'])))
+
+if comm.rank==0:
+    print('threads | t total | speedup | t jacobian | speedup | efficiency')
+    t1, tj1 = timings[0][1], timings[0][2]
+    for nthreads, t, tj in timings:
+        print('{:7d} | {:7.3f} | {:7.2f} | {:10.3f} | {:7.2f} | {:10.2f}'.format(nthreads, t, t1/t, tj, tj1/tj, tj1/tj/nthreads))
+
+petsc.Finalize()
@@ -43,6 +43,8 @@ opts = {"ksp_type" : "gmres",
         #"ksp_view" : "",
         "pc_type" : "none"}
 # pmat = petsc.FlatPETScMatrix(a.mat, X.FreeDofs())
+# (no fes=X: the components of V are not interleaved in the compound space, node-blocks for
+#  "pc_type" : "vpbjacobi" would only have size 1 here)
 pmat = petsc.PETScMatrix(a.mat, X.FreeDofs())
 inv_stokes = petsc.KSP(mat=pmat, name="ngs", petsc_options=opts, finalize=False)
 
@@ -1,11 +1,11 @@
 from . import libpetscinterface
 
 # general utilities
-libpetscinterface.__all__ = ["Initialize", "Finalize"]
+libpetscinterface.__all__ = ["Initialize", "Finalize", "NumLivePETScObjects"]
 
 # linear algebra
 libpetscinterface.__all__ += ["PETScBaseMatrix", "PETScMatrix",
-                              "FlatPETScMatrix"]
+                              "FlatPETScMatrix", "FloatPETScMatrix"]
 try:
    import petsc4py
    libpetscinterface.__all__ += ["VecMap"]
@@ -14,10 +14,10 @@ except ImportError:
 
 # preconditioners
 libpetscinterface.__all__ += ["PETScPrecond", "PETSc2NGsPrecond", "ConvertNGsPrecond", "NGs2PETScPrecond",
-                              "HypreAMSPrecond", "FieldSplitPrecond"]
+                              "HypreAMSPrecond", "HypreADSPrecond", "FieldSplitPrecond", "BDDCPrecond"]
 
 # linear solver
-libpetscinterface.__all__ += ["KSP"]
+libpetscinterface.__all__ += ["KSP", "IterativeRefinement"]
 
 # nmon-linear solver
 libpetscinterface.__all__ += ["SNES"]
@@ -25,7 +25,8 @@ libpetscinterface.__all__ += ["SNES"]
 
 from .libpetscinterface import *
 
-# this calls Finalize before all PETSc objects can be cleaned up ...
+# this calls Finalize before all PETSc objects can be cleaned up; Finalize releases the
+# PETSc objects of everything that is still alive at that point
 import atexit
 atexit.register(libpetscinterface.Finalize)
 libpetscinterface.Initialize()
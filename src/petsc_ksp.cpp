@@ -36,7 +36,7 @@ namespace ngs_petsc_interface
   }
 
   PETScKSP :: PETScKSP (shared_ptr<PETScBaseMatrix> _petsc_mat, FlatArray<string> _opts, string _name)
-    : BaseMatrix(_petsc_mat->GetRowMap()->GetParallelDofs()), petsc_mat(_petsc_mat), own_ksp(true)
+    : BaseMatrix(_petsc_mat->GetRowMap()->GetParallelDofs()), petsc_mat(_petsc_mat)
   {
     auto pds = petsc_mat->GetRowMap()->GetParallelDofs();
     MPI_Comm comm;
@@ -73,8 +73,11 @@ namespace ngs_petsc_interface
 
 
   PETScKSP :: PETScKSP (shared_ptr<PETScBaseMatrix> _petsc_mat, KSP _ksp)
-    : petsc_mat(_petsc_mat), ksp(_ksp), own_ksp(false)
+    : petsc_mat(_petsc_mat), ksp(_ksp)
   {
+    // the KSP belongs to someone else (e.g. a SNES), we only keep a reference
+    ReferencePETScObject((PetscObject)_ksp);
+
     // Tell PETSc to allocate space to store residual history (per default 1e4) and to reset for each solve
     KSPSetResidualHistory(GetKSP(), NULL, PETSC_DECIDE, PETSC_TRUE);
   }
@@ -84,8 +87,6 @@ namespace ngs_petsc_interface
     {
       petsc_pc = nullptr;
       petsc_mat = nullptr;
-      if (own_ksp)
-	{ /* KSPDestroy(&ksp); */ }
     }
 
 
@@ -113,17 +114,115 @@ namespace ngs_petsc_interface
     static ngs::Timer ts("PETSc::KSP::Solve");
     ngs::RegionTimer rts(tm);
 
-    GetMatrix()->GetRowMap()->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs);
+    // identity maps: PETSc works on the NGSolve-vectors directly
+    auto row_map = GetMatrix()->GetRowMap(), col_map = GetMatrix()->GetColMap();
+    bool alias_rhs = row_map->IsIdentity();
+    bool alias_sol = col_map->IsIdentity() && (x.FV<PETScScalar>().Data() != y.FV<PETScScalar>().Data());
+
+    if (alias_rhs)
+      { VecPlaceArray(petsc_rhs, x.FV<PETScScalar>().Data()); }
+    else
+      { row_map->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs); }
+    if (alias_sol)
+      { VecPlaceArray(petsc_sol, y.FV<PETScScalar>().Data()); }
 
     {
       ngs::RegionTimer rts(ts);
       KSPSolve(GetKSP(), petsc_rhs, petsc_sol);
     }
 
-    GetMatrix()->GetColMap()->PETSc2NGs(y, petsc_sol);
+    if (alias_rhs)
+      { VecResetArray(petsc_rhs); }
+    if (alias_sol)
+      { VecResetArray(petsc_sol); }
+    else
+      { col_map->PETSc2NGs(y, petsc_sol); }
 
   }
 
+
+  void PETScKSP :: MatSolve (FlatArray<shared_ptr<ngs::BaseVector>> x, FlatArray<shared_ptr<ngs::BaseVector>> y) const
+  {
+    static ngs::Timer tm("PETSc::KSP::MatSolve");
+    static ngs::Timer ts("PETSc::KSP::MatSolve - solve");
+    ngs::RegionTimer rtm(tm);
+
+    if (x.Size() != y.Size())
+      { throw Exception(string("PETScKSP::MatSolve needs as many solution- as rhs-vectors, got ") + to_string(y.Size()) + string(" and ") + to_string(x.Size())); }
+    if (x.Size() == 0)
+      { return; }
+
+    auto row_map = GetMatrix()->GetRowMap(), col_map = GetMatrix()->GetColMap();
+
+    PETScMat B = row_map->CreatePETScDenseMatrix(x.Size());
+    PETScMat X = col_map->CreatePETScDenseMatrix(y.Size());
+
+    row_map->NGs2PETSc(x, B);
+
+    {
+      ngs::RegionTimer rts(ts);
+      KSPMatSolve(GetKSP(), B, X);
+    }
+
+    col_map->PETSc2NGs(y, X);
+
+    MatDestroy(&B);
+    MatDestroy(&X);
+  } // PETScKSP::MatSolve
+
+
+  PETScIterativeRefinement :: PETScIterativeRefinement (shared_ptr<PETScBaseMatrix> _amat, shared_ptr<PETScKSP> _inner,
+							double _rtol, int _maxit)
+    : BaseMatrix(_amat->GetRowMap()->GetParallelDofs()), amat(_amat), inner(_inner), rtol(_rtol), maxit(_maxit)
+  {
+    auto inner_mat = inner->GetMatrix();
+    if ( (inner_mat->GetRowMap()->GetNRowsGlobal() != amat->GetRowMap()->GetNRowsGlobal()) ||
+	 (inner_mat->GetColMap()->GetNRowsGlobal() != amat->GetColMap()->GetNRowsGlobal()) )
+      { throw Exception("IterativeRefinement: the inner KSP has to work on the same PETSc rows as the matrix!"); }
+
+    // A: x (row map) -> b (col map)
+    petsc_b = amat->GetColMap()->CreatePETScVector();
+    petsc_r = amat->GetColMap()->CreatePETScVector();
+    petsc_x = amat->GetRowMap()->CreatePETScVector();
+    petsc_d = amat->GetRowMap()->CreatePETScVector();
+  }
+
+
+  void PETScIterativeRefinement :: Mult (const ngs::BaseVector & b, ngs::BaseVector & x) const
+  {
+    static ngs::Timer tm("PETSc::IterativeRefinement::Mult");
+    static ngs::Timer ts("PETSc::IterativeRefinement - inner solve");
+    ngs::RegionTimer rtm(tm);
+
+    amat->GetColMap()->NGs2PETSc(const_cast<ngs::BaseVector&>(b), petsc_b);
+
+    VecSet(petsc_x, 0.0);
+    VecCopy(petsc_b, petsc_r);
+    PetscReal norm_b, norm_r;
+    VecNorm(petsc_b, NORM_2, &norm_b);
+    norm_r = norm_b;
+    errs.SetSize(0); errs.Append(norm_r);
+    inner_reason = KSP_CONVERGED_ITERATING;
+
+    for (nits = 0; (nits < maxit) && (norm_r > rtol * norm_b); nits++) {
+      {
+	ngs::RegionTimer rts(ts);
+	KSPSolve(inner->GetKSP(), petsc_r, petsc_d);
+      }
+      // a diverged inner solve gives no usable correction
+      KSPGetConvergedReason(inner->GetKSP(), &inner_reason);
+      if (inner_reason < 0)
+	{ break; }
+      VecAXPY(petsc_x, 1.0, petsc_d);
+      MatMult(amat->GetPETScMat(), petsc_x, petsc_r); // r = A x
+      VecAYPX(petsc_r, -1.0, petsc_b);                // r = b - A x
+      VecNorm(petsc_r, NORM_2, &norm_r);
+      errs.Append(norm_r);
+    }
+
+    amat->GetRowMap()->PETSc2NGs(x, petsc_x);
+  } // PETScIterativeRefinement::Mult
+
 } // namespace ngs_petsc_interface
 
 #include "python_ngspetsc.hpp"
@@ -186,6 +285,7 @@ namespace ngs_petsc_interface {
 	  auto zzo = ksp->GetMatrix()->GetRowMap()->CreatePETScVector();
 	  ksp->GetMatrix()->GetRowMap()->NGs2PETSc(*const_vecs[2], zzo);
 	  PCHYPRESetEdgeConstantVectors(pc, ozz, zoz, zzo);
+	  VecDestroy(&ozz); VecDestroy(&zoz); VecDestroy(&zzo);
 
 	   }, py::arg("grad_mat"), py::arg("xyz_const_vecs"))
 #endif // PETSC_HAVE_HYPRE
@@ -194,6 +294,21 @@ namespace ngs_petsc_interface {
 	  aksp->SetPC(apc);
 	})
       .def("Finalize", [](shared_ptr<PETScKSP> & aksp) { aksp->Finalize(); })
+      .def("MatSolve", [](shared_ptr<PETScKSP> & aksp, py::object rhs, py::object sol) {
+	  // a list of vectors or a MultiVector
+	  auto get_vecs = [](py::object vecs) {
+	    Array<shared_ptr<ngs::BaseVector>> avecs(py::len(vecs));
+	    for (auto k : Range(avecs.Size()))
+	      { avecs[k] = vecs.attr("__getitem__")(k).cast<shared_ptr<ngs::BaseVector>>(); }
+	    return avecs;
+	  };
+	  auto rhs_vecs = get_vecs(rhs), sol_vecs = get_vecs(sol);
+	  aksp->MatSolve(rhs_vecs, sol_vecs);
+	}, py::arg("rhs"), py::arg("sol"), docu_string(R"raw_string(
+Solves for all right hand sides in rhs at once (KSPMatSolve). rhs and sol are lists of vectors or MultiVectors
+of the same length. Block Krylov methods (e.g. -ksp_type hpddm) profit most, other methods solve column by column.
+Shell operators and NGSolve preconditioners are applied to all columns with one MultiMultAdd, which is only
+faster than column by column if the NGSolve operator implements it.)raw_string"))
       .def_property_readonly("results",
 			     [] (PETScKSP & aksp) -> py::dict {
 			       KSP ksp = aksp.GetKSP();
@@ -218,6 +333,30 @@ namespace ngs_petsc_interface {
       .def("GetKSP", [](shared_ptr<PETScKSP> & ksp) { return pbholder<KSP>(ksp->GetKSP()); })
 #endif //  PETSc4Py_INTERFACE
       ;
+
+    py::class_<PETScIterativeRefinement, shared_ptr<PETScIterativeRefinement>, ngs::BaseMatrix>
+      (m, "IterativeRefinement", docu_string(R"raw_string(
+Iterative refinement in double precision around an inner KSP, x += ksp * (b - mat * x) until
+|b - mat * x| <= rtol * |b|. Use a KSP on a FloatPETScMatrix (or with a float Pmat, real PETSc only) as
+inner solver, the final accuracy is that of mat. Stops if the inner KSP diverges, results["inner_conv_r"]
+then holds its reason.)raw_string"))
+      .def(py::init<>
+	   ([&] (shared_ptr<PETScBaseMatrix> mat, shared_ptr<PETScKSP> ksp, double rtol, int maxit) {
+	     return make_shared<PETScIterativeRefinement>(mat, ksp, rtol, maxit);
+	   }), py::arg("mat"), py::arg("ksp"), py::arg("rtol") = 1e-12, py::arg("maxit") = 20)
+      .def_property_readonly("results",
+			     [] (PETScIterativeRefinement & ir) -> py::dict {
+			       auto results = py::dict();
+			       results["nits"] = py::int_(ir.GetNumIterations());
+			       auto py_r_l = py::list();
+			       for (auto r : ir.GetResiduals())
+				 { py_r_l.append(py::float_(r)); }
+			       results["errs"] = py_r_l;
+			       results["inner_conv_r"] = py::str(name_reason(ir.GetInnerReason()));
+			       results["diverged"] = py::bool_(ir.GetInnerReason() < 0);
+			       return results;
+			     })
+      ;
   } // ExportKSP
 
 } // namespace ngs_petsc_interface
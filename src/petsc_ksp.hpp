@@ -25,10 +25,13 @@ namespace ngs_petsc_interface
     void Finalize ();
 
     shared_ptr<PETScBaseMatrix> GetMatrix () const { return petsc_mat; }
-    INLINE KSP& GetKSP () { return ksp; }
+    INLINE KSP& GetKSP () { return ksp.Get(); }
     INLINE KSP GetKSP () const { return ksp; }
     
     virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override;
+
+    /** Solves for multiple right hand sides at once (KSPMatSolve) **/
+    void MatSolve (FlatArray<shared_ptr<ngs::BaseVector>> x, FlatArray<shared_ptr<ngs::BaseVector>> y) const;
     virtual void MultTransAdd (double val, const ngs::BaseVector & x, ngs::BaseVector & y) const override
     { y = 0; Mult(x,y); y *= val; }
     virtual void MultTransAdd (ngs::Complex val, const ngs::BaseVector & x, ngs::BaseVector & y) const override
@@ -43,8 +46,42 @@ namespace ngs_petsc_interface
   protected:
     shared_ptr<PETScBaseMatrix> petsc_mat;
     shared_ptr<PETScBasePrecond> petsc_pc;
-    PETScVec petsc_rhs, petsc_sol;
-    KSP ksp; bool own_ksp;
+    PETScHandle<PETScVec> petsc_rhs, petsc_sol;
+    PETScHandle<KSP> ksp;
+  };
+
+
+  /**
+     Iterative refinement in PETScScalar around an inner KSP (e.g. one on a FloatPETScMatrix):
+       x += inner(b - A x)   until  |b - A x| <= rtol |b|
+     Stops early if the inner KSP diverges, GetInnerReason() then returns its (negative) reason.
+   **/
+  class PETScIterativeRefinement : public ngs::BaseMatrix
+  {
+  public:
+    PETScIterativeRefinement (shared_ptr<PETScBaseMatrix> _amat, shared_ptr<PETScKSP> _inner,
+			      double _rtol = 1e-12, int _maxit = 20);
+
+    virtual void Mult (const ngs::BaseVector & b, ngs::BaseVector & x) const override;
+
+    virtual ngs::AutoVector CreateRowVector () const override { return amat->GetRowMap()->CreateNGsVector(); }
+    virtual ngs::AutoVector CreateColVector () const override { return amat->GetColMap()->CreateNGsVector(); }
+    virtual int VHeight () const override { return amat->VHeight(); }
+    virtual int VWidth () const override { return amat->VWidth(); }
+
+    int GetNumIterations () const { return nits; }
+    FlatArray<double> GetResiduals () const { return errs; }
+    KSPConvergedReason GetInnerReason () const { return inner_reason; }
+
+  protected:
+    shared_ptr<PETScBaseMatrix> amat;
+    shared_ptr<PETScKSP> inner;
+    double rtol;
+    int maxit;
+    PETScHandle<PETScVec> petsc_b, petsc_x, petsc_r, petsc_d;
+    mutable int nits = 0;
+    mutable Array<double> errs;
+    mutable KSPConvergedReason inner_reason = KSP_CONVERGED_ITERATING;
   };
 
 } // namespace ngs_petsc_interface
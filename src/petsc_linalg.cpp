@@ -12,9 +12,421 @@ namespace ngs_petsc_interface
   template<> INLINE Complex* get_ptr<Complex> (Complex & val) { return &val; }
 
 
+  /** Numbers the entries in the subset consecutively, others get -1. Returns the size of the subset. **/
+  INLINE int CompressSubSet (size_t n, shared_ptr<ngs::BitArray> ss, Array<int> & compress)
+  {
+    compress.SetSize(n);
+    int cnt = 0;
+    for (auto k : Range(n))
+      { compress[k] = (!ss || ss->Test(k)) ? cnt++ : -1; }
+    return cnt;
+  }
+
+
+  /**
+     Block-CSR graph of (the subset-block of) an NGSolve sparse matrix, in PETSc numbering.
+     Symmetric matrices are expanded to full storage.
+     For every PETSc block-entry, src is the position of the NGSolve block-entry it is taken from,
+     and trans (only filled for symmetric matrices) says whether that block has to be transposed.
+  **/
+  struct SeqCSRGraph
+  {
+    Array<PETScInt> ia, ja;
+    Array<size_t> src;
+    Array<bool> trans;
+    size_t n_filtered = 0; // number of (scalar) entries dropped by the C2C-filter
+  };
+
+
+  /**
+     For C2C matrices (pdrow/pdcol given), the same coupling is stored on multiple ranks.
+     We only keep entries where we are master of row-dof OR col-dof.
+  **/
+  INLINE bool KeepC2CEntry (const shared_ptr<ngs::ParallelDofs> & pdrow, const shared_ptr<ngs::ParallelDofs> & pdcol, size_t k, size_t j)
+  {
+    return (pdcol == nullptr) || pdcol->IsMasterDof(k) || pdrow->IsMasterDof(j);
+  }
+
+
+  template<class TM>
+  void BuildSeqCSRGraph (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, FlatArray<int> row_compress,
+			 FlatArray<int> col_compress, int nbcol, SeqCSRGraph & graph,
+			 shared_ptr<ngs::ParallelDofs> pdrow = nullptr, shared_ptr<ngs::ParallelDofs> pdcol = nullptr)
+  {
+    static ngs::Timer t(string("BuildSeqCSRGraph<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS2 = ngs::mat_traits<TM>::HEIGHT * ngs::mat_traits<TM>::HEIGHT;
+    bool symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) != nullptr;
+    auto & ia = graph.ia; auto & ja = graph.ja; auto & src = graph.src;
+    auto keep = [&](size_t k, size_t j) { return (row_compress[j] != -1) && KeepC2CEntry(pdrow, pdcol, k, j); };
+
+    // count entries per row
+    ia.SetSize(nbcol+1); ia = 0;
+    graph.n_filtered = 0;
+    ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	size_t nf = 0;
+	for (auto k : r) {
+	  auto ck = col_compress[k];
+	  if (ck == -1) continue;
+	  PETScInt c = 0;
+	  for (auto j : spmat->GetRowIndices(k)) {
+	    auto cj = row_compress[j];
+	    if (cj == -1) continue;
+	    if (!keep(k, j))
+	      { nf += (symmetric && (cj != ck)) ? 2 : 1; continue; }
+	    c++;
+	    if (symmetric && (cj != ck)) // mirrored entry (cj > ck never happens, NGSolve stores the lower part)
+	      { AsAtomic(ia[cj+1])++; }
+	  }
+	  AsAtomic(ia[ck+1]) += c;
+	}
+	AsAtomic(graph.n_filtered) += BS2 * nf;
+      });
+    for (auto k : Range(nbcol))
+      { ia[k+1] += ia[k]; }
+
+    ja.SetSize(ia.Last()); src.SetSize(ia.Last());
+
+    if (!symmetric) {
+      ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	  for (auto k : r) {
+	    auto ck = col_compress[k];
+	    if (ck == -1) continue;
+	    auto ris = spmat->GetRowIndices(k);
+	    size_t first = spmat->First(k);
+	    PETScInt pos = ia[ck];
+	    for (auto j : Range(ris.Size())) {
+	      if (keep(k, ris[j]))
+		{ ja[pos] = row_compress[ris[j]]; src[pos++] = first + j; }
+	    }
+	  }
+	});
+    }
+    else {
+      /**
+	 Row ck gets its own (lower) entries first, then the mirrored ones from rows below it.
+	 Filling the mirrored entries in ascending order of the source row keeps the rows sorted,
+	 so that part has to stay sequential.
+      **/
+      graph.trans.SetSize(ia.Last());
+      Array<PETScInt> pos(nbcol);
+      ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	  for (auto k : r) {
+	    auto ck = col_compress[k];
+	    if (ck == -1) continue;
+	    auto ris = spmat->GetRowIndices(k);
+	    size_t first = spmat->First(k);
+	    PETScInt p = ia[ck];
+	    for (auto j : Range(ris.Size())) {
+	      if (keep(k, ris[j]))
+		{ ja[p] = row_compress[ris[j]]; src[p] = first + j; graph.trans[p++] = false; }
+	    }
+	    pos[ck] = p;
+	  }
+	});
+      for (auto k : Range(spmat->Height())) {
+	auto ck = col_compress[k];
+	if (ck == -1) continue;
+	auto ris = spmat->GetRowIndices(k);
+	size_t first = spmat->First(k);
+	for (auto j : Range(ris.Size())) {
+	  auto cj = row_compress[ris[j]];
+	  if ( keep(k, ris[j]) && (cj != ck) ) {
+	    auto p = pos[cj]++;
+	    ja[p] = ck; src[p] = first + j; graph.trans[p] = true;
+	  }
+	}
+      }
+    }
+  } // BuildSeqCSRGraph
+
+
+  template<class TM, class TV>
+  void FillSeqCSRValues (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, const SeqCSRGraph & graph, TV * vals)
+  {
+    static ngs::Timer t(string("FillSeqCSRValues<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+    constexpr int BS2 = BS * BS;
+    const PETScScalar * ngs_vals = spmat->AsVector().template FV<PETScScalar>().Data();
+    bool symmetric = graph.trans.Size() > 0;
+    ParallelForRange (Range(graph.src.Size()), [&] (auto r) {
+	for (auto s : r) {
+	  const PETScScalar * ngs_block = ngs_vals + BS2 * graph.src[s];
+	  TV * block = vals + BS2 * s;
+	  if (symmetric && graph.trans[s]) {
+	    for (int a = 0; a < BS; a++)
+	      for (int b = 0; b < BS; b++)
+		{ block[BS*a+b] = ngs_block[BS*b+a]; }
+	  }
+	  else {
+	    for (int l = 0; l < BS2; l++)
+	      { block[l] = ngs_block[l]; }
+	  }
+	}
+      });
+  } // FillSeqCSRValues
+
+
+  /**
+     Builds the complete (block-)CSR arrays and hands them to PETSc in one call.
+     (MatSeq(B)AIJSetPreallocationCSR expects blocks stored consecutively, row-major - same as NGSolve)
+  **/
+  template<class TM>
+  PETScMat CreatePETScMatSeqBAIJBulk (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+				      shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol, size_t & n_filtered)
+  {
+    static_assert(ngs::mat_traits<TM>::WIDTH == ngs::mat_traits<TM>::HEIGHT, "PETSc can only handle square block entries!");
+
+    static ngs::Timer t(string("CreatePETScMatSeqBAIJBulk<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+
+    Array<int> row_compress, col_compress;
+    int nbrow = CompressSubSet(spmat->Width(), rss, row_compress);
+    int nbcol = CompressSubSet(spmat->Height(), css, col_compress);
+
+    SeqCSRGraph graph;
+    BuildSeqCSRGraph(spmat, row_compress, col_compress, nbcol, graph, pdrow, pdcol);
+    n_filtered = graph.n_filtered;
+
+    Array<PETScScalar> vals(BS * BS * graph.src.Size());
+    FillSeqCSRValues(spmat, graph, vals.Data());
+
+    PETScMat petsc_mat;
+    MatCreate(PETSC_COMM_SELF, &petsc_mat);
+    MatSetSizes(petsc_mat, BS * nbcol, BS * nbrow, BS * nbcol, BS * nbrow);
+    if (BS == 1) {
+      MatSetType(petsc_mat, MATSEQAIJ);
+      MatSeqAIJSetPreallocationCSR(petsc_mat, graph.ia.Data(), graph.ja.Data(), vals.Data());
+    }
+    else {
+      MatSetType(petsc_mat, MATSEQBAIJ);
+      MatSeqBAIJSetPreallocationCSR(petsc_mat, BS, graph.ia.Data(), graph.ja.Data(), vals.Data());
+    }
+
+    return petsc_mat;
+  } // CreatePETScMatSeqBAIJBulk
+
+
+  /**
+     Block-CSR arrays of the upper triangle for a symmetric NGSolve matrix (which stores the lower one),
+     in the same format as BuildSeqCSRGraph. Row and column subset have to be the same.
+  **/
+  template<class TM>
+  void BuildSeqSBAIJGraph (shared_ptr<ngs::SparseMatrixSymmetric<TM>> spmat, FlatArray<int> compress,
+			   int nb, SeqCSRGraph & graph, shared_ptr<ngs::ParallelDofs> pd = nullptr)
+  {
+    static ngs::Timer t(string("BuildSeqSBAIJGraph<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS2 = ngs::mat_traits<TM>::HEIGHT * ngs::mat_traits<TM>::HEIGHT;
+    auto & ia = graph.ia; auto & ja = graph.ja;
+    auto keep = [&](size_t k, size_t j) { return (compress[j] != -1) && KeepC2CEntry(pd, pd, k, j); };
+
+    ia.SetSize(nb+1); ia = 0;
+    graph.n_filtered = 0;
+    ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	size_t nf = 0;
+	for (auto k : r) {
+	  if (compress[k] == -1) continue;
+	  for (auto j : spmat->GetRowIndices(k)) {
+	    if (keep(k, j))
+	      { AsAtomic(ia[compress[j]+1])++; }
+	    else if (compress[j] != -1)
+	      { nf++; }
+	  }
+	}
+	AsAtomic(graph.n_filtered) += BS2 * nf;
+      });
+    for (auto k : Range(nb))
+      { ia[k+1] += ia[k]; }
+
+    ja.SetSize(ia.Last()); graph.src.SetSize(ia.Last()); graph.trans.SetSize(ia.Last());
+
+    // NGSolve row k becomes PETSc column ck, going through k in order keeps the PETSc rows sorted
+    Array<PETScInt> pos(nb);
+    for (auto k : Range(nb))
+      { pos[k] = ia[k]; }
+    for (auto k : Range(spmat->Height())) {
+      auto ck = compress[k];
+      if (ck == -1) continue;
+      auto ris = spmat->GetRowIndices(k);
+      size_t first = spmat->First(k);
+      for (auto j : Range(ris.Size())) {
+	auto cj = compress[ris[j]];
+	if (keep(k, ris[j])) {
+	  auto p = pos[cj]++;
+	  ja[p] = ck; graph.src[p] = first + j; graph.trans[p] = (cj != ck);
+	}
+      }
+    }
+  } // BuildSeqSBAIJGraph
+
+
+  template<class TM>
+  PETScMat CreatePETScMatSeqSBAIJ (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<ngs::BitArray> ss,
+				   shared_ptr<ngs::ParallelDofs> pd, size_t & n_filtered)
+  {
+    static_assert(ngs::mat_traits<TM>::WIDTH == ngs::mat_traits<TM>::HEIGHT, "PETSc can only handle square block entries!");
+
+    static ngs::Timer t(string("CreatePETScMatSeqSBAIJ<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    auto sym_spm = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat);
+    if (sym_spm == nullptr)
+      { throw Exception("SBAIJ format needs a symmetric NGSolve matrix!"); }
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+
+    Array<int> compress;
+    int nb = CompressSubSet(spmat->Height(), ss, compress);
+
+    SeqCSRGraph graph;
+    BuildSeqSBAIJGraph(sym_spm, compress, nb, graph, pd);
+    n_filtered = graph.n_filtered;
+
+    Array<PETScScalar> vals(BS * BS * graph.src.Size());
+    FillSeqCSRValues(spmat, graph, vals.Data());
+
+    PETScMat petsc_mat;
+    MatCreate(PETSC_COMM_SELF, &petsc_mat);
+    MatSetSizes(petsc_mat, BS * nb, BS * nb, BS * nb, BS * nb);
+    MatSetType(petsc_mat, MATSEQSBAIJ);
+    MatSeqSBAIJSetPreallocationCSR(petsc_mat, BS, graph.ia.Data(), graph.ja.Data(), vals.Data());
+
+    return petsc_mat;
+  } // CreatePETScMatSeqSBAIJ
+
+
+  /**
+     Same matrices as CreatePETScMatSeqBAIJBulk/CreatePETScMatSeqSBAIJ, without the complete (block-)CSR arrays.
+     Only the row lengths are computed up front, the values are gathered for chunks of NGSolve rows whose
+     buffers fit into mem_budget bytes and inserted block by block. The budget includes the O(n) compress-
+     and row length arrays, the chunks get what is left (but always at least one row).
+  **/
+  template<class TM>
+  PETScMat CreatePETScMatSeqChunked (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+				     bool sbaij, shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol,
+				     size_t mem_budget, size_t & n_filtered)
+  {
+    static_assert(ngs::mat_traits<TM>::WIDTH == ngs::mat_traits<TM>::HEIGHT, "PETSc can only handle square block entries!");
+
+    static ngs::Timer t(string("CreatePETScMatSeqChunked<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+    constexpr int BS2 = BS * BS;
+
+    bool symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) != nullptr;
+    if (sbaij && !symmetric)
+      { throw Exception("SBAIJ format needs a symmetric NGSolve matrix!"); }
+
+    Array<int> row_compress, col_compress;
+    int nbrow = CompressSubSet(spmat->Width(), rss, row_compress);
+    int nbcol = CompressSubSet(spmat->Height(), css, col_compress);
+    auto keep = [&](size_t k, size_t j) { return (row_compress[j] != -1) && KeepC2CEntry(pdrow, pdcol, k, j); };
+
+    // NGSolve block (k,j) goes to PETSc block (ck,cj), for symmetric matrices also transposed to (cj,ck).
+    // SBAIJ only gets the transposed one (NGSolve has the lower, PETSc the upper triangle)
+    const bool direct = !sbaij;
+    auto mirror = [&](PETScInt ck, PETScInt cj) { return sbaij || (symmetric && (cj != ck)); };
+
+    Array<PETScInt> nnz(nbcol); nnz = 0;
+    n_filtered = 0;
+    ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	size_t nf = 0;
+	for (auto k : r) {
+	  auto ck = col_compress[k];
+	  if (ck == -1) continue;
+	  for (auto j : spmat->GetRowIndices(k)) {
+	    auto cj = row_compress[j];
+	    if (cj == -1) continue;
+	    if (!keep(k, j))
+	      { nf += (direct ? 1 : 0) + (mirror(ck, cj) ? 1 : 0); continue; }
+	    if (direct)
+	      { AsAtomic(nnz[ck])++; }
+	    if (mirror(ck, cj))
+	      { AsAtomic(nnz[cj])++; }
+	  }
+	}
+	AsAtomic(n_filtered) += BS2 * nf;
+      });
+
+    PETScMat petsc_mat;
+    MatCreate(PETSC_COMM_SELF, &petsc_mat);
+    MatSetSizes(petsc_mat, BS * nbcol, BS * nbrow, BS * nbcol, BS * nbrow);
+    if (sbaij) {
+      MatSetType(petsc_mat, MATSEQSBAIJ);
+      MatSeqSBAIJSetPreallocation(petsc_mat, BS, 0, nnz.Data());
+    }
+    else if (BS == 1) {
+      MatSetType(petsc_mat, MATSEQAIJ);
+      MatSeqAIJSetPreallocation(petsc_mat, 0, nnz.Data());
+    }
+    else {
+      MatSetType(petsc_mat, MATSEQBAIJ);
+      MatSeqBAIJSetPreallocation(petsc_mat, BS, 0, nnz.Data());
+    }
+
+    // every NGSolve block gets up to two slots (direct and mirrored), each with row, col and values
+    const int nslots = (symmetric && !sbaij) ? 2 : 1;
+    const size_t slot_bytes = nslots * (BS2 * sizeof(PETScScalar) + 2 * sizeof(PETScInt));
+    const size_t fixed_bytes = sizeof(int) * (row_compress.Size() + col_compress.Size()) + sizeof(PETScInt) * nnz.Size();
+    const size_t chunk_budget = (mem_budget > fixed_bytes) ? (mem_budget - fixed_bytes) : 0;
+    const size_t max_chunk = max(size_t(1), chunk_budget / slot_bytes);
+    const PETScScalar * ngs_vals = spmat->AsVector().template FV<PETScScalar>().Data();
+    Array<PETScInt> brow, bcol;
+    Array<PETScScalar> bvals;
+    size_t h = spmat->Height();
+    for (size_t k0 = 0; k0 < h; ) {
+      // as many rows as fit into the budget, but at least one
+      size_t k1 = k0 + 1;
+      while ( (k1 < h) && (spmat->First(k1+1) - spmat->First(k0) <= max_chunk) )
+	{ k1++; }
+      size_t base = spmat->First(k0);
+      size_t nslots_chunk = nslots * (spmat->First(k1) - base);
+      brow.SetSize(nslots_chunk); bcol.SetSize(nslots_chunk); bvals.SetSize(BS2 * nslots_chunk);
+      brow = -1;
+      ParallelForRange (Range(k0, k1), [&] (auto r) {
+	  for (auto k : r) {
+	    PETScInt ck = col_compress[k];
+	    if (ck == -1) continue;
+	    auto ris = spmat->GetRowIndices(k);
+	    size_t first = spmat->First(k);
+	    for (auto j : Range(ris.Size())) {
+	      if (!keep(k, ris[j])) continue;
+	      PETScInt cj = row_compress[ris[j]];
+	      const PETScScalar * ngs_block = ngs_vals + BS2 * (first + j);
+	      size_t s = nslots * (first + j - base);
+	      if (direct) {
+		brow[s] = ck; bcol[s] = cj;
+		for (int l = 0; l < BS2; l++)
+		  { bvals[BS2*s + l] = ngs_block[l]; }
+		s++;
+	      }
+	      if (mirror(ck, cj)) {
+		brow[s] = cj; bcol[s] = ck;
+		for (int a = 0; a < BS; a++)
+		  for (int b = 0; b < BS; b++)
+		    { bvals[BS2*s + BS*a + b] = ngs_block[BS*b + a]; }
+	      }
+	    }
+	  }
+	});
+      for (auto s : Range(nslots_chunk))
+	if (brow[s] != -1)
+	  { MatSetValuesBlocked(petsc_mat, 1, &brow[s], 1, &bcol[s], &bvals[BS2 * s], INSERT_VALUES); }
+      k0 = k1;
+    }
+    MatAssemblyBegin(petsc_mat, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(petsc_mat, MAT_FINAL_ASSEMBLY);
+
+    return petsc_mat;
+  } // CreatePETScMatSeqChunked
+
+
   template<class TM>
   void SetPETScMatSeq (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat,
-		       shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css)
+		       shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+		       shared_ptr<ngs::ParallelDofs> pdrow = nullptr, shared_ptr<ngs::ParallelDofs> pdcol = nullptr)
   {
     static ngs::Timer t(string("SetPETScMatSeq<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
 
@@ -50,11 +462,13 @@ namespace ngs_petsc_interface
 	auto rvs = spmat->GetRowValues(k);
 	for (auto j : Range(ris.Size())) {
 	  PETScInt cj = row_compress[ris[j]];
-	  if (cj != -1) {
+	  if ( (cj != -1) && KeepC2CEntry(pdrow, pdcol, k, ris[j]) ) {
 	    PETScScalar* data = get_ptr(rvs[j]);
 	    MatSetValuesBlocked(petsc_mat, 1, &ck, 1, &cj, data, INSERT_VALUES);
-	    if (symmetric)
-	      { MatSetValuesBlocked(petsc_mat, 1, &cj, 1, &ck, data, INSERT_VALUES); }
+	    if (symmetric && (cj != ck)) {
+	      TM tval = ngs::Trans(rvs[j]);
+	      MatSetValuesBlocked(petsc_mat, 1, &cj, 1, &ck, get_ptr(tval), INSERT_VALUES);
+	    }
 	  }
 	}
       }
@@ -65,17 +479,19 @@ namespace ngs_petsc_interface
 
 
   template<class TM>
-  void SetPETScMatIS (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css)
+  void SetPETScMatIS (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+		      shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol)
   {
     /** If the PETSc-Mat is in MATIS format, we can just directly replace entries in it's local matrix **/
 
     PETScMat local_mat; MatISGetLocalMat(petsc_mat, &local_mat);
-    SetPETScMatSeq (local_mat, spmat, rss, css);
+    SetPETScMatSeq (local_mat, spmat, rss, css, pdrow, pdcol);
   } // SetPETScMatPar
 
 
   template<class TM>
-  void SetPETScMatPar (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<NGs2PETScVecMap> row_map, shared_ptr<NGs2PETScVecMap> col_map)
+  void SetPETScMatPar (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<NGs2PETScVecMap> row_map, shared_ptr<NGs2PETScVecMap> col_map,
+		       shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol)
   {
     /**
        We have to zero out the matrix and then ADD values (instead of SET them)
@@ -89,6 +505,9 @@ namespace ngs_petsc_interface
 
     auto row_dm = row_map->GetDOFMap();
     auto col_dm = col_map->GetDOFMap();
+
+    // (the global numbering does not keep the local order, so for SBAIJ either one of these can be the upper entry)
+    bool symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) != nullptr;
     
     MatZeroEntries(petsc_mat);
 
@@ -99,9 +518,13 @@ namespace ngs_petsc_interface
 	auto rvs = spmat->GetRowValues(k);
 	for (auto j : Range(ris.Size())) {
 	  PETScInt cj = row_dm[ris[j]];
-	  if (cj != -1) {
+	  if ( (cj != -1) && KeepC2CEntry(pdrow, pdcol, k, ris[j]) ) {
 	    PETScScalar* data = get_ptr(rvs[j]);
 	    MatSetValuesBlocked(petsc_mat, 1, &ck, 1, &cj, data, ADD_VALUES);
+	    if (symmetric && (ris[j] != k)) {
+	      TM tval = ngs::Trans(rvs[j]);
+	      MatSetValuesBlocked(petsc_mat, 1, &cj, 1, &ck, get_ptr(tval), ADD_VALUES);
+	    }
 	  }
 	}
       }
@@ -111,20 +534,276 @@ namespace ngs_petsc_interface
   } // SetPETScMatPar
 
 
+  /** For C2C matrices, give pdrow/pdcol so that duplicate entries are skipped **/
   template<class TM>
-  void SetPETScMat (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<NGs2PETScVecMap> row_map, shared_ptr<NGs2PETScVecMap> col_map)
+  void SetPETScMat (PETScMat petsc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat, shared_ptr<NGs2PETScVecMap> row_map, shared_ptr<NGs2PETScVecMap> col_map,
+		    shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol)
   {
     MatType petsc_type; MatGetType(petsc_mat, &petsc_type); string type(petsc_type);
     if (type == string(MATIS))
-      { SetPETScMatIS(petsc_mat, spmat, row_map->GetSubSet(), col_map->GetSubSet()); }
-    else if ( (type == string(MATMPIAIJ)) || (type == string(MATMPIBAIJ)) )
-      { SetPETScMatPar(petsc_mat, spmat, row_map, col_map); }
-    else if ( (type == string(MATSEQAIJ)) || (type == string(MATSEQBAIJ)) )
-      { SetPETScMatSeq(petsc_mat, spmat, row_map->GetSubSet(), col_map->GetSubSet()); }
+      { SetPETScMatIS(petsc_mat, spmat, row_map->GetSubSet(), col_map->GetSubSet(), pdrow, pdcol); }
+    else if ( (type == string(MATMPIAIJ)) || (type == string(MATMPIBAIJ)) || (type == string(MATMPISBAIJ)) )
+      { SetPETScMatPar(petsc_mat, spmat, row_map, col_map, pdrow, pdcol); }
+    else if ( (type == string(MATSEQAIJ)) || (type == string(MATSEQBAIJ)) || (type == string(MATSEQSBAIJ)) )
+      { SetPETScMatSeq(petsc_mat, spmat, row_map->GetSubSet(), col_map->GetSubSet(), pdrow, pdcol); }
     else
       { throw Exception("Cannot update values for PETSc matrix of this type!!"); }
   }
 
+  /**
+     Computes, for every value of a sequential PETSc matrix (SEQAIJ or SEQBAIJ), the position of the
+     NGSolve value it is taken from. Mirrored entries of symmetric matrices are transposed, duplicate
+     C2C entries (pdrow/pdcol given, see KeepC2CEntry) are skipped or left at zero.
+  **/
+  template<class TM>
+  void BuildUpdatePlanTM (PETScMat loc_mat, shared_ptr<ngs::SparseMatrixTM<TM>> spmat,
+			  shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+			  shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol,
+			  PETScMatrix::UpdatePlan & plan)
+  {
+    static ngs::Timer t(string("BuildUpdatePlanTM<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+    constexpr int BS2 = BS * BS;
+
+    PETScMatType mt; MatGetType(loc_mat, &mt);
+    bool sbaij = string(mt) == string(MATSEQSBAIJ); // only upper triangle, NGSolve has the lower one
+    bool blocked = sbaij || ( (BS > 1) && (string(mt) == string(MATSEQBAIJ)) );
+    if ( !blocked && (string(mt) != string(MATSEQAIJ)) )
+      { return; }
+    if ( sbaij && (dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) == nullptr) )
+      { return; }
+
+    PETScInt bs; MatGetBlockSize(loc_mat, &bs);
+    if (blocked && (bs != BS))
+      { return; }
+
+    Array<int> row_compress, col_compress;
+    CompressSubSet(spmat->Width(), rss, row_compress);
+    CompressSubSet(spmat->Height(), css, col_compress);
+
+    bool symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) != nullptr;
+
+    PETScInt n; const PETScInt *ia, *ja; PetscBool done;
+    MatGetRowIJ(loc_mat, 0, PETSC_FALSE, blocked ? PETSC_TRUE : PETSC_FALSE, &n, &ia, &ja, &done);
+    if (!done)
+      { return; }
+
+    const int nv = blocked ? BS2 : 1; // scalars per PETSc entry
+    const size_t NONE = size_t(-1);
+    plan.src.SetSize(nv * size_t(ia[n]));
+    plan.src = NONE;
+
+    std::atomic<bool> all_found(true);
+    auto find = [&](PETScInt row, PETScInt col) -> PETScInt {
+      auto beg = ja + ia[row], end = ja + ia[row+1];
+      auto it = std::lower_bound(beg, end, col);
+      if ( (it == end) || (*it != col) )
+	{ all_found = false; return -1; }
+      return it - ja;
+    };
+
+    /** position of value (a,b) of block p in block row row: MatSetValuesBlocked takes a block row
+	as BS rows of the complete (row-oriented) BS x (nc*BS) array, not block by block **/
+    auto bpos = [&](PETScInt row, PETScInt p, int a, int b) -> size_t {
+      return BS2 * ia[row] + size_t(a) * BS * (ia[row+1] - ia[row]) + BS * (p - ia[row]) + b;
+    };
+
+    /** every PETSc value has at most one source, so threads never write the same position **/
+    ParallelForRange (Range(spmat->Height()), [&] (auto r) {
+	for (auto k : r) {
+	  auto ck = col_compress[k];
+	  if (ck == -1) continue;
+	  auto ris = spmat->GetRowIndices(k);
+	  size_t first = spmat->First(k);
+	  for (auto j : Range(ris.Size())) {
+	    PETScInt cj = row_compress[ris[j]];
+	    if (cj == -1) continue;
+	    if (!KeepC2CEntry(pdrow, pdcol, k, ris[j])) continue;
+	    size_t ngs_pos = BS2 * (first + j);
+	    bool mirror = symmetric && (cj != ck);
+	    if (sbaij) {
+	      PETScInt p = find(cj, ck);
+	      if (p != -1) {
+		for (int a = 0; a < BS; a++)
+		  for (int b = 0; b < BS; b++)
+		    { plan.src[bpos(cj, p, a, b)] = ngs_pos + BS*b + a; }
+	      }
+	    }
+	    else if (blocked) {
+	      PETScInt p = find(ck, cj);
+	      if (p != -1) {
+		for (int a = 0; a < BS; a++)
+		  for (int b = 0; b < BS; b++)
+		    { plan.src[bpos(ck, p, a, b)] = ngs_pos + BS*a + b; }
+	      }
+	      if ( mirror && ((p = find(cj, ck)) != -1) ) {
+		for (int a = 0; a < BS; a++)
+		  for (int b = 0; b < BS; b++)
+		    { plan.src[bpos(cj, p, a, b)] = ngs_pos + BS*b + a; }
+	      }
+	    }
+	    else {
+	      for (int a = 0; a < BS; a++)
+		for (int b = 0; b < BS; b++) {
+		  PETScInt p = find(BS*ck + a, BS*cj + b);
+		  if (p != -1)
+		    { plan.src[p] = ngs_pos + BS*a + b; }
+		  if ( mirror && ((p = find(BS*cj + b, BS*ck + a)) != -1) )
+		    { plan.src[p] = ngs_pos + BS*a + b; }
+		}
+	    }
+	  }
+	}
+      });
+
+    if (blocked) {
+      plan.rowptr.SetSize(n+1);
+      for (auto k : Range(n+1))
+	{ plan.rowptr[k] = ia[k]; }
+      plan.cols.SetSize(ia[n]);
+      for (auto k : Range(ia[n]))
+	{ plan.cols[k] = ja[k]; }
+      plan.buffer.SetSize(plan.src.Size());
+    }
+
+    MatRestoreRowIJ(loc_mat, 0, PETSC_FALSE, blocked ? PETSC_TRUE : PETSC_FALSE, &n, &ia, &ja, &done);
+
+    // PETSc has entries we do not know about - should not happen, but better safe than sorry
+    if (!all_found) {
+      plan = PETScMatrix::UpdatePlan();
+      return;
+    }
+
+    plan.bs = blocked ? BS : 1;
+    plan.set_blocked = blocked;
+    plan.identity = false;
+    if ( !blocked && (plan.src.Size() == BS2 * spmat->NZE()) ) {
+      std::atomic<bool> ident(true);
+      ParallelForRange (Range(plan.src.Size()), [&] (auto r) {
+	  for (auto l : r)
+	    if (plan.src[l] != l)
+	      { ident = false; break; }
+	});
+      plan.identity = ident;
+    }
+    plan.valid = true;
+  } // BuildUpdatePlanTM
+
+
+  /**
+     Global scalar COO entries for the sub-assembled local matrices of a parallel NGSolve matrix.
+     Entries from different ranks for the same position are summed up by PETSc, same as for a MATIS.
+     src is the position of the NGSolve value of every COO entry.
+  **/
+  template<class TM>
+  void BuildCOOTM (shared_ptr<ngs::SparseMatrixTM<TM>> spmat, FlatArray<PETScInt> row_dm, FlatArray<PETScInt> col_dm,
+		   shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol,
+		   Array<PETScInt> & coo_i, Array<PETScInt> & coo_j, Array<size_t> & src, size_t & n_filtered)
+  {
+    static ngs::Timer t(string("BuildCOOTM<Mat<") + to_string(ngs::mat_traits<TM>::HEIGHT) + string(">>")); ngs::RegionTimer rt(t);
+
+    constexpr int BS = ngs::mat_traits<TM>::HEIGHT;
+    constexpr int BS2 = BS * BS;
+
+    bool symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<TM>>(spmat) != nullptr;
+
+    auto keep = [&](size_t k, size_t j) {
+      return (col_dm[k] != -1) && (row_dm[j] != -1) && KeepC2CEntry(pdrow, pdcol, k, j);
+    };
+
+    // number of COO entries per NGSolve row
+    size_t h = spmat->Height();
+    Array<size_t> offset(h+1);
+    offset[0] = 0;
+    n_filtered = 0;
+    ParallelForRange (Range(h), [&] (auto r) {
+	size_t nf = 0;
+	for (auto k : r) {
+	  size_t c = 0;
+	  for (auto j : spmat->GetRowIndices(k)) {
+	    size_t cnt = (symmetric && (j != k)) ? 2 : 1;
+	    if (keep(k, j))
+	      { c += cnt; }
+	    else if ( (col_dm[k] != -1) && (row_dm[j] != -1) )
+	      { nf += cnt; }
+	  }
+	  offset[k+1] = BS2 * c;
+	}
+	AsAtomic(n_filtered) += BS2 * nf;
+      });
+    for (auto k : Range(h))
+      { offset[k+1] += offset[k]; }
+
+    coo_i.SetSize(offset[h]); coo_j.SetSize(offset[h]); src.SetSize(offset[h]);
+    ParallelForRange (Range(h), [&] (auto r) {
+	for (auto k : r) {
+	  auto ris = spmat->GetRowIndices(k);
+	  size_t first = spmat->First(k);
+	  size_t pos = offset[k];
+	  for (auto j : Range(ris.Size())) {
+	    if (!keep(k, ris[j])) continue;
+	    PETScInt gk = col_dm[k], gj = row_dm[ris[j]];
+	    size_t ngs_pos = BS2 * (first + j);
+	    for (int a = 0; a < BS; a++)
+	      for (int b = 0; b < BS; b++)
+		{ coo_i[pos] = BS*gk + a; coo_j[pos] = BS*gj + b; src[pos++] = ngs_pos + BS*a + b; }
+	    if (symmetric && (ris[j] != k)) { // mirrored, transposed block
+	      for (int a = 0; a < BS; a++)
+		for (int b = 0; b < BS; b++)
+		  { coo_i[pos] = BS*gj + b; coo_j[pos] = BS*gk + a; src[pos++] = ngs_pos + BS*a + b; }
+	    }
+	  }
+	}
+      });
+  } // BuildCOOTM
+
+
+  /** Updates the values of a PETSc matrix with a plan from BuildUpdatePlanTM or BuildCOOTM **/
+  void ApplyUpdatePlan (PETScMat loc_mat, PETScMatrix::UpdatePlan & plan, ngs::BaseMatrix & spmat)
+  {
+    static ngs::Timer t("ApplyUpdatePlan"); ngs::RegionTimer rt(t);
+
+    auto ngs_vals = spmat.AsVector().FV<PETScScalar>();
+    auto gather = [&](PETScScalar * vals) {
+      if (plan.identity)
+	{ memcpy(vals, ngs_vals.Data(), plan.src.Size() * sizeof(PETScScalar)); }
+      else {
+	ParallelForRange (Range(plan.src.Size()), [&] (auto r) {
+	    for (auto l : r) {
+	      auto s = plan.src[l];
+	      vals[l] = (s == size_t(-1)) ? PETScScalar(0) : ngs_vals(s);
+	    }
+	  });
+      }
+    };
+
+    if (plan.coo) {
+      gather(plan.buffer.Data());
+      MatSetValuesCOO(loc_mat, plan.buffer.Data(), INSERT_VALUES);
+    }
+    else if (!plan.set_blocked) {
+      PETScScalar * vals;
+      MatSeqAIJGetArray(loc_mat, &vals);
+      gather(vals);
+      MatSeqAIJRestoreArray(loc_mat, &vals);
+    }
+    else {
+      // (S)BAIJ stores blocks column-major internally, so we go through MatSetValuesBlocked, one call per block row
+      // (the plan stores every block row in the row-oriented layout MatSetValuesBlocked expects)
+      gather(plan.buffer.Data());
+      const int bs2 = plan.bs * plan.bs;
+      for (PETScInt k = 0; k + 1 < PETScInt(plan.rowptr.Size()); k++) {
+	PETScInt nc = plan.rowptr[k+1] - plan.rowptr[k];
+	if (nc > 0)
+	  { MatSetValuesBlocked(loc_mat, 1, &k, nc, &plan.cols[plan.rowptr[k]], &plan.buffer[bs2 * plan.rowptr[k]], INSERT_VALUES); }
+      }
+      MatAssemblyBegin(loc_mat, MAT_FINAL_ASSEMBLY);
+      MatAssemblyEnd(loc_mat, MAT_FINAL_ASSEMBLY);
+    }
+  } // ApplyUpdatePlan
+
+
   template<class TM>
   PETScMat CreatePETScMatSeqBAIJFromSymmetric (shared_ptr<ngs::SparseMatrixSymmetric<TM>> spmat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css)
   {
@@ -302,24 +981,77 @@ namespace ngs_petsc_interface
   } // CreatePETScMatSeqBAIJ
 
 
-  PETScMat CreatePETScMatSeq (shared_ptr<ngs::BaseMatrix> mat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css)
+  /**
+     If pdrow/pdcol are given, duplicate C2C entries are filtered out (SBAIJ or bulk_csr only, see ConvertMat)
+     and n_filtered is the number of dropped entries.
+  **/
+  PETScMat CreatePETScMatSeq (shared_ptr<ngs::BaseMatrix> mat, shared_ptr<ngs::BitArray> rss, shared_ptr<ngs::BitArray> css,
+			      bool sbaij, shared_ptr<ngs::ParallelDofs> pdrow, shared_ptr<ngs::ParallelDofs> pdcol,
+			      const ConversionOptions & opts, size_t & n_filtered)
   {
     PETScMat ret = NULL;
+    n_filtered = 0;
     Iterate<MAX_SYS_DIM>([&](auto n) {
 	constexpr int N = 1 + n;
+	auto create = [&](auto spm) {
+	  if (opts.mem_budget > 0)
+	    { ret = CreatePETScMatSeqChunked(spm, rss, sbaij ? rss : css, sbaij, pdrow, sbaij ? pdrow : pdcol,
+					     opts.mem_budget, n_filtered); }
+	  else if (sbaij)
+	    { ret = CreatePETScMatSeqSBAIJ(spm, rss, pdrow, n_filtered); }
+	  else if (opts.bulk_csr)
+	    { ret = CreatePETScMatSeqBAIJBulk(spm, rss, css, pdrow, pdcol, n_filtered); }
+	  else
+	    { ret = CreatePETScMatSeqBAIJ(spm, rss, css); }
+	};
 	if constexpr(N==1) {
 	    if (auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat))
-	      { ret = CreatePETScMatSeqBAIJ(spm, rss, css); }
+	      { create(spm); }
 	  }
 	else {
 	  if (auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<ngs::Mat<N, N, PETScScalar>>>(mat))
-	    { ret = CreatePETScMatSeqBAIJ(spm, rss, css); }
+	    { create(spm); }
 	}
       });
     return ret;
   } // CreatePETScMatSeq
 
 
+  /**
+     Wraps the CSR arrays of a scalar, non-symmetric NGSolve matrix into a SEQAIJ matrix without copying.
+     Only the row pointers have to be copied (NGSolve uses size_t for these).
+     Returns NULL if that is not possible.
+  **/
+  PETScMat CreatePETScMatSeqAIJAlias (shared_ptr<ngs::BaseMatrix> mat, Array<PETScInt> & rowptr)
+  {
+    static ngs::Timer t("CreatePETScMatSeqAIJAlias"); ngs::RegionTimer rt(t);
+
+    auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat);
+    if ( (spmat == nullptr) || (dynamic_pointer_cast<ngs::SparseMatrixSymmetric<PETScScalar>>(mat) != nullptr) )
+      { return NULL; }
+
+    // NGSolve column indices are ints
+    if (sizeof(PETScInt) != sizeof(int))
+      { return NULL; }
+
+    size_t h = spmat->Height();
+    if (spmat->First(h) > size_t(std::numeric_limits<PETScInt>::max()))
+      { return NULL; }
+
+    rowptr.SetSize(h+1);
+    for (auto k : Range(h+1))
+      { rowptr[k] = spmat->First(k); }
+
+    static PETScInt dummy_col = 0;
+    PETScInt * cols = (h > 0) ? reinterpret_cast<PETScInt*>(spmat->GetRowIndices(0).Data()) : &dummy_col;
+    PETScScalar * vals = spmat->AsVector().FV<PETScScalar>().Data();
+
+    PETScMat petsc_mat;
+    MatCreateSeqAIJWithArrays(PETSC_COMM_SELF, h, spmat->Width(), rowptr.Data(), cols, vals, &petsc_mat);
+    return petsc_mat;
+  } // CreatePETScMatSeqAIJAlias
+
+
   /**
      Only leaves entries in the matrix where we are master of row-dof OR col-dof.
      ( -> do this for the local mats of a C2C-ParallelMatrix)
@@ -357,14 +1089,22 @@ namespace ngs_petsc_interface
     TM zero(0);
     PETScScalar* data = get_ptr(zero);
 
+    // SBAIJ only has the upper triangle
+    PETScMatType mt; MatGetType(petsc_mat, &mt);
+    bool sbaij = string(mt) == string(MATSEQSBAIJ);
+
     for (auto k : Range(spmat->Height())) {
       PETScInt ck = col_compress[k];
       if ( (ck == -1) || pdcol->IsMasterDof(k) ) continue;
       auto ri = spmat->GetRowIndices(k);
       for (auto j : Range(ri.Size())) {
 	PETScInt cj = row_compress[ri[j]];
-	if ( (cj != -1) && !pdrow->IsMasterDof(ri[j]) )
-	  { MatSetValuesBlocked(petsc_mat, 1, &ck, 1, &cj, data, INSERT_VALUES); }
+	if ( (cj != -1) && !pdrow->IsMasterDof(ri[j]) ) {
+	  if (sbaij && (cj < ck))
+	    { MatSetValuesBlocked(petsc_mat, 1, &cj, 1, &ck, data, INSERT_VALUES); }
+	  else
+	    { MatSetValuesBlocked(petsc_mat, 1, &ck, 1, &cj, data, INSERT_VALUES); }
+	}
       }
     }
 
@@ -450,7 +1190,29 @@ namespace ngs_petsc_interface
 	    { compress_globnums[cnt++] = globnums[k]; }
 	}
 	compress_globnums.SetSize(cnt);
-	ISLocalToGlobalMappingCreate(pardofs->GetCommunicator(), bs, compress_globnums.Size(), &compress_globnums[0], PETSC_COPY_VALUES, &is_map);
+	ISLocalToGlobalMappingCreate(pardofs->GetCommunicator(), bs, compress_globnums.Size(), &compress_globnums[0], PETSC_COPY_VALUES, &is_map.Get());
+
+	/**
+	   Distributed -> PETSc only needs the non-master values at their master, not a full Cumulate.
+	   (the PETSc rows of a rank are consecutive, in the order of it's master DOFs, so the global row is enough for the SF)
+	**/
+	Array<PETScInt> ilocal, iremote;
+	for (auto k : Range(ndof))
+	  if ( (dof_map[k] != -1) && !pardofs->IsMasterDof(k) )
+	    for (auto l : Range(bs))
+	      { ilocal.Append(bs * k + l); iremote.Append(bs * dof_map[k] + l); }
+	size_t nrows_mine = 0;
+	for (auto k : Range(ndof))
+	  if ( (dof_map[k] != -1) && pardofs->IsMasterDof(k) )
+	    { nrows_mine += bs; }
+	PetscLayout layout;
+	PetscLayoutCreate(pardofs->GetCommunicator(), &layout);
+	PetscLayoutSetLocalSize(layout, nrows_mine);
+	PetscLayoutSetUp(layout);
+	PetscSFCreate(pardofs->GetCommunicator(), &sf.Get());
+	PetscSFSetGraphLayout(sf, layout, ilocal.Size(), ilocal.Data(), PETSC_COPY_VALUES, iremote.Data());
+	PetscSFSetUp(sf);
+	PetscLayoutDestroy(&layout);
       }
       else // subset + sequential
 	{
@@ -461,12 +1223,203 @@ namespace ngs_petsc_interface
 	}
     }
     nrows_glob = (pardofs == nullptr) ? nrows_loc : pardofs->GetCommunicator().AllReduce(nrows_loc, MPI_SUM);
+
+    // runs of DOFs that go to the PETSc-vector, so we do not have to check every DOF for every transfer
+    run_first.SetSize0(); run_offset.SetSize0();
+    size_t cnt = 0;
+    bool in_run = false;
+    for (auto k : Range(ndof)) {
+      bool inc = (!pardofs || pardofs->IsMasterDof(k)) && (!subset || subset->Test(k));
+      if (inc && !in_run)
+	{ run_first.Append(bs * k); run_offset.Append(cnt); }
+      in_run = inc;
+      if (inc)
+	{ cnt += bs; }
+    }
+    run_offset.Append(cnt);
+    identity = (nrows_loc == bs * ndof);
   }
 
+
+  template<class FUNC>
+  INLINE void NGs2PETScVecMap :: ParallelIterateRuns (FUNC f) const
+  {
+    ParallelForRange (Range(nrows_loc), [&] (auto r) {
+	if (r.Size() == 0) return;
+	// the run that contains the first row of this chunk
+	size_t run = std::upper_bound(run_offset.Data(), run_offset.Data() + run_offset.Size(), size_t(r.First())) - run_offset.Data() - 1;
+	size_t row = r.First();
+	while (row < r.Next()) {
+	  size_t end = min2(size_t(run_offset[run+1]), size_t(r.Next()));
+	  f(run_first[run] + (row - run_offset[run]), row, end - row);
+	  row = end;
+	  run++;
+	}
+      });
+  } // NGs2PETScVecMap::ParallelIterateRuns
+
+
+  template<class FUNC>
+  INLINE void NGs2PETScVecMap :: ParallelIterateGaps (FUNC f) const
+  {
+    size_t nruns = run_first.Size();
+    ParallelForRange (Range(nruns+1), [&] (auto r) {
+	for (auto gap : r) {
+	  size_t first = (gap == 0) ? 0 : run_first[gap-1] + (run_offset[gap] - run_offset[gap-1]);
+	  size_t next = (gap == nruns) ? bs * ndof : run_first[gap];
+	  if (next > first)
+	    { f(first, next - first); }
+	}
+      });
+  } // NGs2PETScVecMap::ParallelIterateGaps
+
+  shared_ptr<NGs2PETScVecMap> NGs2PETScVecMap :: CreateInterleaved (shared_ptr<ngs::FESpace> fes, shared_ptr<ngs::BitArray> subset)
+  {
+    static ngs::Timer t("NGs2PETScVecMap::CreateInterleaved"); ngs::RegionTimer rt(t);
+
+    auto comp_fes = dynamic_pointer_cast<ngs::CompoundFESpace>(fes);
+    if ( (comp_fes == nullptr) || (comp_fes->GetNSpaces() < 2) || (comp_fes->GetNSpaces() > MAX_SYS_DIM) )
+      { return nullptr; }
+    int ncomp = comp_fes->GetNSpaces();
+    auto space0 = (*comp_fes)[0];
+    size_t nd = space0->GetNDof();
+    for (auto l : Range(ncomp)) {
+      auto space = (*comp_fes)[l];
+      if ( (typeid(*space) != typeid(*space0)) || (space->GetNDof() != nd) || (space->GetDimension() != 1) ||
+	   (size_t(comp_fes->GetRange(l).First()) != l * nd) )
+	{ return nullptr; }
+    }
+
+    // a node is in the map if any of its components is
+    shared_ptr<ngs::BitArray> node_subset;
+    if (subset != nullptr) {
+      node_subset = make_shared<ngs::BitArray>(nd);
+      node_subset->Clear();
+      for (auto k : Range(nd))
+	for (auto l : Range(ncomp))
+	  if (subset->Test(l * nd + k))
+	    { node_subset->SetBit(k); break; }
+    }
+
+    // the components have the same distant procs, so one of them does the job
+    shared_ptr<ngs::ParallelDofs> node_pardofs;
+    if (fes->IsParallel()) {
+      auto pd0 = space0->GetParallelDofs();
+      ngs::TableCreator<int> creator(nd);
+      for ( ; !creator.Done(); creator++)
+	for (auto k : Range(nd))
+	  for (auto p : pd0->GetDistantProcs(k))
+	    { creator.Add(k, p); }
+      node_pardofs = make_shared<ngs::ParallelDofs>(pd0->GetCommunicator(), creator.MoveTable(), ncomp, false);
+    }
+
+    auto map = make_shared<NGs2PETScVecMap>(nd, ncomp, node_pardofs, node_subset);
+    map->interleaved = true;
+    map->identity = false;
+    map->entry_subset = subset;
+    map->entry_pardofs = fes->GetParallelDofs();
+    return map;
+  } // NGs2PETScVecMap::CreateInterleaved
+
+
+  PETScScalar * NGs2PETScVecMap :: Interleave (ngs::BaseVector & ngs_vec)
+  {
+    perm_buf.SetSize(bs * ndof);
+    const PETScScalar * fv = ngs_vec.FV<PETScScalar>().Data();
+    ParallelForRange (Range(ndof), [&] (auto r) {
+	for (auto k : r)
+	  for (auto l : Range(bs)) {
+	    size_t entry = l * ndof + k;
+	    perm_buf[bs * k + l] = InEntrySubSet(entry) ? fv[entry] : PETScScalar(0);
+	  }
+      });
+    return perm_buf.Data();
+  } // NGs2PETScVecMap::Interleave
+
+
+  void NGs2PETScVecMap :: DeInterleave (const PETScScalar * buf, ngs::BaseVector & ngs_vec, bool add)
+  {
+    PETScScalar * fv = ngs_vec.FV<PETScScalar>().Data();
+    ParallelForRange (Range(ndof), [&] (auto r) {
+	for (auto k : r)
+	  for (auto l : Range(bs)) {
+	    size_t entry = l * ndof + k;
+	    if (!InEntrySubSet(entry))
+	      { if (!add) { fv[entry] = 0; } }
+	    else if (add)
+	      { fv[entry] += buf[bs * k + l]; }
+	    else
+	      { fv[entry] = buf[bs * k + l]; }
+	  }
+      });
+  } // NGs2PETScVecMap::DeInterleave
+
+
+  bool NGs2PETScVecMap :: SetVariableBlockSizes (shared_ptr<ngs::FESpace> fes)
+  {
+    static ngs::Timer t("NGs2PETScVecMap::SetVariableBlockSizes"); ngs::RegionTimer rt(t);
+
+    var_bs.SetSize0();
+
+    // for interleaved maps, the nodes of the map are the DOFs of the first component
+    auto space = fes;
+    if (interleaved) {
+      auto comp_fes = dynamic_pointer_cast<ngs::CompoundFESpace>(fes);
+      if ( (comp_fes == nullptr) || (comp_fes->GetNSpaces() != bs) )
+	{ return false; }
+      space = (*comp_fes)[0];
+    }
+    if (space->GetNDof() != ndof)
+      { return false; }
+
+    // the components (also of nested compound spaces) and their first DOF
+    Array<shared_ptr<ngs::FESpace>> comp_spaces;
+    Array<size_t> comp_offset;
+    std::function<void(shared_ptr<ngs::FESpace>, size_t)> add_space = [&](shared_ptr<ngs::FESpace> sp, size_t offset) {
+      if (auto comp_sp = dynamic_pointer_cast<ngs::CompoundFESpace>(sp)) {
+	for (auto k : Range(comp_sp->GetNSpaces()))
+	  { add_space((*comp_sp)[k], offset + comp_sp->GetRange(k).First()); }
+      }
+      else
+	{ comp_spaces.Append(sp); comp_offset.Append(offset); }
+    };
+    add_space(space, 0);
+
+    // one block per node and component
+    auto ma = fes->GetMeshAccess();
+    Array<int> dof_block(ndof); dof_block = -1;
+    int nblocks = 0;
+    Array<ngs::DofId> dnums;
+    for (auto comp : Range(comp_spaces))
+      for (auto nt : { ngs::NT_VERTEX, ngs::NT_EDGE, ngs::NT_FACE, ngs::NT_CELL })
+	for (auto k : Range(ma->GetNNodes(nt))) {
+	  comp_spaces[comp]->GetDofNrs(ngs::NodeId(nt, k), dnums);
+	  bool has_dofs = false;
+	  for (auto d : dnums)
+	    if (d >= 0)
+	      { dof_block[comp_offset[comp] + d] = nblocks; has_dofs = true; }
+	  if (has_dofs)
+	    { nblocks++; }
+	}
+
+    // local rows are in the order of the DOFs, a block is cut where another one is in between
+    int last_block = -1;
+    for (auto k : Range(ndof)) {
+      if ( (pardofs && !pardofs->IsMasterDof(k)) || (subset && !subset->Test(k)) )
+	{ continue; }
+      if ( (dof_block[k] != -1) && (dof_block[k] == last_block) )
+	{ var_bs.Last() += bs; }
+      else
+	{ var_bs.Append(bs); }
+      last_block = dof_block[k];
+    }
+    return true;
+  } // NGs2PETScVecMap::SetVariableBlockSizes
+
+
   NGs2PETScVecMap :: ~NGs2PETScVecMap ()
   {
-    if (IsParallel())
-      { /* ISLocalToGlobalMappingDestroy(&is_map); */ }
+    // is_map and sf are released by their handles
   }
 
 
@@ -478,17 +1431,30 @@ namespace ngs_petsc_interface
   }
 
 
+  void NGs2PETScVecMap :: GatherNGs2PETSc (ngs::BaseVector& ngs_vec, PETScScalar * pvs)
+  {
+    PETScScalar * fv = interleaved ? Interleave(ngs_vec) : ngs_vec.FV<PETScScalar>().Data();
+    if (identity)
+      { memcpy(pvs, fv, nrows_loc * sizeof(PETScScalar)); }
+    else {
+      ParallelIterateRuns([&](size_t nf, size_t pf, size_t len) {
+	  memcpy(pvs + pf, fv + nf, len * sizeof(PETScScalar));
+	});
+    }
+    // sum up the contributions of the other ranks at the master, ngs_vec stays distributed
+    if ( (sf != NULL) && (ngs_vec.GetParallelStatus() == ngs::DISTRIBUTED) ) {
+      static ngs::Timer t("NGs2PETScVecMap::GatherNGs2PETSc - reduce"); ngs::RegionTimer rt(t);
+      PetscSFReduceBegin(sf, MPIU_SCALAR, fv, pvs, MPIU_SUM);
+      PetscSFReduceEnd(sf, MPIU_SCALAR, fv, pvs, MPIU_SUM);
+    }
+  } // NGs2PETScVecMap::GatherNGs2PETSc
+
+
   void NGs2PETScVecMap :: NGs2PETSc (ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
   {
     static ngs::Timer t("NGs2PETScVecMap::NGs2PETSc"); ngs::RegionTimer rt(t);
-    ngs_vec.Cumulate();
     PETScScalar * pvs; VecGetArray(petsc_vec, &pvs);
-    size_t cnt = 0;
-    auto fv = ngs_vec.FV<PETScScalar>();
-    for (auto k : Range(ndof))
-      if ( (!pardofs || pardofs->IsMasterDof(k)) && (!subset || subset->Test(k)))
-	for (auto l : Range(bs))
-	  { pvs[cnt++] = fv(bs*k+l); }
+    GatherNGs2PETSc(ngs_vec, pvs);
     VecRestoreArray(petsc_vec, &pvs);
   } // NGs2PETSc
 
@@ -497,14 +1463,28 @@ namespace ngs_petsc_interface
   INLINE void NGs2PETScVecMap :: AddNGs2PETSc_impl (TSCAL scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
   {
     static ngs::Timer t("NGs2PETScVecMap::AddNGs2PETSc"); ngs::RegionTimer rt(t);
-    ngs_vec.Cumulate();
     PETScScalar * pvs; VecGetArray(petsc_vec, &pvs);
-    size_t cnt = 0;
-    auto fv = ngs_vec.FV<PETScScalar>();
-    for (auto k : Range(ndof))
-      if ( (!pardofs || pardofs->IsMasterDof(k)) && (!subset || subset->Test(k)))
-	for (auto l : Range(bs))
-	  { pvs[cnt++] += scal * fv(bs*k+l); }
+    const PETScScalar * fv = ngs_vec.FV<PETScScalar>().Data();
+    Array<PETScScalar> buf;
+    if ( (sf != NULL) && (ngs_vec.GetParallelStatus() == ngs::DISTRIBUTED) ) {
+      // we need the summed up values before scaling and adding
+      buf.SetSize(nrows_loc);
+      GatherNGs2PETSc(ngs_vec, buf.Data());
+      ParallelForRange (Range(nrows_loc), [&] (auto r) {
+	  for (auto l : r)
+	    { pvs[l] += scal * buf[l]; }
+	});
+      VecRestoreArray(petsc_vec, &pvs);
+      return;
+    }
+    if (interleaved)
+      { fv = Interleave(ngs_vec); }
+    ParallelIterateRuns([&](size_t nf, size_t pf, size_t len) {
+	PETScScalar * __restrict__ p = pvs + pf;
+	const PETScScalar * __restrict__ n = fv + nf;
+	for (size_t l = 0; l < len; l++)
+	  { p[l] += scal * n[l]; }
+      });
     VecRestoreArray(petsc_vec, &pvs);
   } // NGs2PETScVecMap::AddNGs2PETSc
 
@@ -523,38 +1503,101 @@ namespace ngs_petsc_interface
   } // NGs2PETScVecMap :: AddNGs2PETSc
 
 
-  void NGs2PETScVecMap :: PETSc2NGs (ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
+  void NGs2PETScVecMap :: PETSc2NGs (ngs::BaseVector& ngs_vec, PETScVec petsc_vec, ngs::PARALLEL_STATUS stat)
   {
     static ngs::Timer t("NGs2PETScVecMap::PETSc2NGs"); ngs::RegionTimer rt(t);
-    ngs_vec.Distribute();
     const PETScScalar * pvs; VecGetArrayRead(petsc_vec, &pvs);
-    size_t cnt = 0;
-    auto fv = ngs_vec.FV<PETScScalar>();
-    for (auto k : Range(ndof))
-      if ( (!pardofs || pardofs->IsMasterDof(k)) && (!subset || subset->Test(k)))
-	for (auto l : Range(bs))
-	  { fv(bs*k+l) = pvs[cnt++]; }
-      else
-	for (auto l : Range(bs))
-	  { fv(bs*k+l) = 0; }
+    ScatterPETSc2NGs(ngs_vec, pvs, stat);
     VecRestoreArrayRead(petsc_vec, &pvs);
   } // PETSc2NGs
 
 
-  template<class TSCAL>
-  INLINE void NGs2PETScVecMap :: AddPETSc2NGs_impl (TSCAL scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
+  void NGs2PETScVecMap :: ScatterPETSc2NGs (ngs::BaseVector& ngs_vec, const PETScScalar * pvs, ngs::PARALLEL_STATUS stat)
   {
-    static ngs::Timer t("NGs2PETScVecMap::AddPETSc2NGs"); ngs::RegionTimer rt(t);
-    ngs_vec.Distribute();
-    const PETScScalar * pvs; VecGetArrayRead(petsc_vec, &pvs);
-    size_t cnt = 0;
-    auto fv = ngs_vec.FV<PETScScalar>();
-    for (auto k : Range(ndof))
-      if ( (!pardofs || pardofs->IsMasterDof(k)) && (!subset || subset->Test(k)))
-	for (auto l : Range(bs))
-	  { fv(bs*k+l) += scal * pvs[cnt++]; }
-    VecRestoreArrayRead(petsc_vec, &pvs);
-  } // AddPETSc2NGs
+    // (we overwrite all values, no need to Distribute first)
+    if (interleaved)
+      { perm_buf.SetSize(bs * ndof); }
+    PETScScalar * fv = interleaved ? perm_buf.Data() : ngs_vec.FV<PETScScalar>().Data();
+    if (identity)
+      { memcpy(fv, pvs, nrows_loc * sizeof(PETScScalar)); }
+    else {
+      ParallelIterateRuns([&](size_t nf, size_t pf, size_t len) {
+	  memcpy(fv + nf, pvs + pf, len * sizeof(PETScScalar));
+	});
+      ParallelIterateGaps([&](size_t first, size_t len) {
+	  for (size_t l = 0; l < len; l++)
+	    { fv[first + l] = 0; }
+	});
+    }
+    // owner -> ghosts, instead of zeros now and a Cumulate later
+    if ( (sf != NULL) && (stat == ngs::CUMULATED) ) {
+      static ngs::Timer t("NGs2PETScVecMap::PETSc2NGs - bcast"); ngs::RegionTimer rt(t);
+      PetscSFBcastBegin(sf, MPIU_SCALAR, pvs, fv, MPI_REPLACE);
+      PetscSFBcastEnd(sf, MPIU_SCALAR, pvs, fv, MPI_REPLACE);
+    }
+    if (interleaved)
+      { DeInterleave(fv, ngs_vec, false); }
+    ngs_vec.SetParallelStatus( (sf != NULL) ? stat : ngs::DISTRIBUTED );
+  } // NGs2PETScVecMap::ScatterPETSc2NGs
+
+
+  PETScMat NGs2PETScVecMap :: CreatePETScDenseMatrix (int ncols) const
+  {
+    PETScMat m;
+    MatCreateDense( (pardofs == nullptr) ? PETSC_COMM_SELF : MPI_Comm(pardofs->GetCommunicator()),
+		    nrows_loc, PETSC_DECIDE, nrows_glob, ncols, NULL, &m);
+    return m;
+  } // NGs2PETScVecMap::CreatePETScDenseMatrix
+
+
+  void NGs2PETScVecMap :: NGs2PETSc (FlatArray<shared_ptr<ngs::BaseVector>> ngs_vecs, PETScMat petsc_dense)
+  {
+    static ngs::Timer t("NGs2PETScVecMap::NGs2PETSc - multi"); ngs::RegionTimer rt(t);
+    PETScScalar * pvs; MatDenseGetArray(petsc_dense, &pvs);
+    PETScInt lda; MatDenseGetLDA(petsc_dense, &lda);
+    for (auto k : Range(ngs_vecs.Size()))
+      { GatherNGs2PETSc(*ngs_vecs[k], pvs + k * lda); }
+    MatDenseRestoreArray(petsc_dense, &pvs);
+  } // NGs2PETScVecMap::NGs2PETSc
+
+
+  void NGs2PETScVecMap :: PETSc2NGs (FlatArray<shared_ptr<ngs::BaseVector>> ngs_vecs, PETScMat petsc_dense, ngs::PARALLEL_STATUS stat)
+  {
+    static ngs::Timer t("NGs2PETScVecMap::PETSc2NGs - multi"); ngs::RegionTimer rt(t);
+    const PETScScalar * pvs; MatDenseGetArrayRead(petsc_dense, &pvs);
+    PETScInt lda; MatDenseGetLDA(petsc_dense, &lda);
+    for (auto k : Range(ngs_vecs.Size()))
+      { ScatterPETSc2NGs(*ngs_vecs[k], pvs + k * lda, stat); }
+    MatDenseRestoreArrayRead(petsc_dense, &pvs);
+  } // NGs2PETScVecMap::PETSc2NGs
+
+
+  template<class TSCAL>
+  INLINE void NGs2PETScVecMap :: AddPETSc2NGs_impl (TSCAL scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
+  {
+    static ngs::Timer t("NGs2PETScVecMap::AddPETSc2NGs"); ngs::RegionTimer rt(t);
+    ngs_vec.Distribute();
+    const PETScScalar * pvs; VecGetArrayRead(petsc_vec, &pvs);
+    if (interleaved) {
+      perm_buf.SetSize(bs * ndof);
+      perm_buf = PETScScalar(0);
+      ParallelIterateRuns([&](size_t nf, size_t pf, size_t len) {
+	  for (size_t l = 0; l < len; l++)
+	    { perm_buf[nf + l] = scal * pvs[pf + l]; }
+	});
+      DeInterleave(perm_buf.Data(), ngs_vec, true);
+      VecRestoreArrayRead(petsc_vec, &pvs);
+      return;
+    }
+    PETScScalar * fv = ngs_vec.FV<PETScScalar>().Data();
+    ParallelIterateRuns([&](size_t nf, size_t pf, size_t len) {
+	PETScScalar * __restrict__ n = fv + nf;
+	const PETScScalar * __restrict__ p = pvs + pf;
+	for (size_t l = 0; l < len; l++)
+	  { n[l] += scal * p[l]; }
+      });
+    VecRestoreArrayRead(petsc_vec, &pvs);
+  } // AddPETSc2NGs
   
 
   void NGs2PETScVecMap :: AddPETSc2NGs (double scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec)
@@ -572,6 +1615,12 @@ namespace ngs_petsc_interface
 
   unique_ptr<ngs::BaseVector> NGs2PETScVecMap :: CreateNGsVector () const
   {
+    if (interleaved) { // vectors of the space, not of the nodes
+      if (entry_pardofs)
+	{ return make_unique<ngs::S_ParallelBaseVectorPtr<PETScScalar>> (entry_pardofs->GetNDofLocal(), entry_pardofs->GetEntrySize(), entry_pardofs, ngs::DISTRIBUTED); }
+      else
+	{ return make_unique<ngs::S_BaseVectorPtr<PETScScalar>> (bs * ndof, 1); }
+    }
     if (pardofs)
       { return make_unique<ngs::S_ParallelBaseVectorPtr<PETScScalar>> (pardofs->GetNDofLocal(), pardofs->GetEntrySize(), pardofs, ngs::DISTRIBUTED); }
     else
@@ -591,12 +1640,21 @@ namespace ngs_petsc_interface
 
   PETScMatrix :: PETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
 			      shared_ptr<ngs::BitArray> _col_subset, shared_ptr<NGs2PETScVecMap> _row_map,
-			      shared_ptr<NGs2PETScVecMap> _col_map)
-    : PETScBaseMatrix(_ngs_mat, _row_subset, _col_subset, _row_map, _col_map)
+			      shared_ptr<NGs2PETScVecMap> _col_map, const ConversionOptions & _conv_opts)
+    : PETScBaseMatrix(_ngs_mat, _row_subset, _col_subset, _row_map, _col_map), conv_opts(_conv_opts)
   {
     static ngs::Timer t("PETScMatrix constructor 1"); ngs::RegionTimer rt(t);
 
-    ConvertMat();
+    if ( ( (row_map != nullptr) && row_map->IsInterleaved() ) || ( (col_map != nullptr) && col_map->IsInterleaved() ) )
+      { CreateInterleavedMatrix(); }
+    else {
+      // (the local matrix would be SEQBAIJ for block entries, and we would end up with MPIBAIJ)
+      if (ConvertMatCOO(false)) {
+	FinishConversion();
+	return;
+      }
+      ConvertMat();
+    }
 
     /**
        No matrix format specified, so we pick a format for the parallel matrix that fits the local matrix.
@@ -614,21 +1672,31 @@ namespace ngs_petsc_interface
       MatISRestoreLocalMat(petsc_mat, &loc_mat);
       // convert the parallel matrix
       pmt = (mt == string(MATSEQAIJ)) ? MATMPIAIJ : MATMPIBAIJ;
-      MatConvert(petsc_mat, pmt, MAT_INPLACE_MATRIX, &petsc_mat);
+      MatConvert(petsc_mat, pmt, MAT_INPLACE_MATRIX, &petsc_mat.Get());
     }
 
+    FinishConversion();
   }
 
 
   PETScMatrix :: PETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
 			      shared_ptr<ngs::BitArray> _col_subset, PETScMatrix::MAT_TYPE _petsc_mat_type,
-			      shared_ptr<NGs2PETScVecMap> _row_map, shared_ptr<NGs2PETScVecMap> _col_map)
-    : PETScBaseMatrix (_ngs_mat, _row_subset, _col_subset, _row_map, _col_map)
+			      shared_ptr<NGs2PETScVecMap> _row_map, shared_ptr<NGs2PETScVecMap> _col_map,
+			      const ConversionOptions & _conv_opts)
+    : PETScBaseMatrix (_ngs_mat, _row_subset, _col_subset, _row_map, _col_map), conv_opts(_conv_opts)
   {
 
     static ngs::Timer t("PETScMatrix constructor 2"); ngs::RegionTimer rt(t);
 
-    ConvertMat();
+    if ( ( (row_map != nullptr) && row_map->IsInterleaved() ) || ( (col_map != nullptr) && col_map->IsInterleaved() ) )
+      { CreateInterleavedMatrix(); }
+    else {
+      if ( (_petsc_mat_type == AIJ) && ConvertMatCOO(true) ) {
+	FinishConversion();
+	return;
+      }
+      ConvertMat(_petsc_mat_type == SBAIJ);
+    }
 
     /**
        Matrix format is specified.
@@ -636,6 +1704,7 @@ namespace ngs_petsc_interface
 	  BAIJ -> SEQBAIJ/MPIBAIJ
 	  IS_AIJ -> local mat to AIJ
 	  IS_BAIJ -> local mat to BAIJ
+	  SBAIJ -> SEQSBAIJ/MPISBAIJ
      **/
 
     PETScMatType pmt;
@@ -648,38 +1717,387 @@ namespace ngs_petsc_interface
       switch(_petsc_mat_type) {
       case AIJ : {
 	MatISRestoreLocalMat(petsc_mat, &loc_mat);
-	MatConvert(petsc_mat, MATMPIAIJ, MAT_INPLACE_MATRIX, &petsc_mat);
+	MatConvert(petsc_mat, MATMPIAIJ, MAT_INPLACE_MATRIX, &petsc_mat.Get());
 	break;
       }
       case BAIJ : {
 	MatISRestoreLocalMat(petsc_mat, &loc_mat);
-	MatConvert(petsc_mat, MATMPIBAIJ, MAT_INPLACE_MATRIX, &petsc_mat);
+	MatConvert(petsc_mat, MATMPIBAIJ, MAT_INPLACE_MATRIX, &petsc_mat.Get());
 	break;
       }
       case IS_AIJ  : {
 	if (loc_mt != string(MATSEQAIJ))
-	  { MatConvert(loc_mat, MATSEQAIJ, MAT_INPLACE_MATRIX, &petsc_mat); }
+	  { MatConvert(loc_mat, MATSEQAIJ, MAT_INPLACE_MATRIX, &loc_mat); }
 	MatISRestoreLocalMat(petsc_mat, &loc_mat);
 	break;
       }
       case IS_BAIJ : {
 	if (loc_mt != string(MATSEQBAIJ))
-	  { MatConvert(loc_mat, MATSEQBAIJ, MAT_INPLACE_MATRIX, &petsc_mat); }
+	  { MatConvert(loc_mat, MATSEQBAIJ, MAT_INPLACE_MATRIX, &loc_mat); }
 	MatISRestoreLocalMat(petsc_mat, &loc_mat);
 	break;
       }
+      case SBAIJ : {
+	MatISRestoreLocalMat(petsc_mat, &loc_mat);
+	MatConvert(petsc_mat, MATMPISBAIJ, MAT_INPLACE_MATRIX, &petsc_mat.Get());
+	break;
+      }
       default: break;
       }
     }
     else {
-      PETScMatType mt = (_petsc_mat_type == AIJ || _petsc_mat_type == IS_AIJ) ? MATSEQAIJ : MATSEQBAIJ;
-      if (pmt != mt)
-	{ MatConvert(petsc_mat, mt, MAT_INPLACE_MATRIX, &petsc_mat); }
+      PETScMatType mt = (_petsc_mat_type == AIJ || _petsc_mat_type == IS_AIJ) ? MATSEQAIJ :
+	( (_petsc_mat_type == SBAIJ) ? MATSEQSBAIJ : MATSEQBAIJ );
+      if (string(pmt) != string(mt))
+	{ MatConvert(petsc_mat, mt, MAT_INPLACE_MATRIX, &petsc_mat.Get()); }
     }
+
+    FinishConversion();
   } // PETScMatrix (..)
 
 
-  void PETScMatrix :: ConvertMat ()
+  void PETScMatrix :: FinishConversion ()
+  {
+    auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+    shared_ptr<BaseMatrix> mat = (parmat == nullptr) ? ngs_mat : parmat->GetMatrix();
+
+    bool symmetric = false;
+    Iterate<MAX_SYS_DIM>([&](auto n) {
+	constexpr int N = 1 + n;
+	if constexpr(N==1)
+	  { symmetric |= dynamic_pointer_cast<ngs::SparseMatrixSymmetric<PETScScalar>>(mat) != nullptr; }
+	else
+	  { symmetric |= dynamic_pointer_cast<ngs::SparseMatrixSymmetric<ngs::Mat<N, N, PETScScalar>>>(mat) != nullptr; }
+      });
+
+    // (an interleaved matrix is converted from the scalar NGSolve matrix)
+    symmetric |= conv_symmetric;
+
+    // symmetric NGSolve matrices stay symmetric, also after UpdateValues
+    if (symmetric) {
+      MatSetOption(petsc_mat, MAT_SYMMETRIC, PETSC_TRUE);
+      MatSetOption(petsc_mat, MAT_SYMMETRY_ETERNAL, PETSC_TRUE);
+    }
+
+    // lets the old update paths insert lower entries without errors
+    PETScMatType pmt; MatGetType(petsc_mat, &pmt);
+    if ( (string(pmt) == string(MATSEQSBAIJ)) || (string(pmt) == string(MATMPISBAIJ)) )
+      { MatSetOption(petsc_mat, MAT_IGNORE_LOWER_TRIANGULAR, PETSC_TRUE); }
+
+    // (the maps can come with block sizes from another matrix)
+    ApplyVariableBlockSizes();
+
+    CheckAlias();
+    BuildUpdatePlan();
+  } // PETScMatrix::FinishConversion
+
+
+  void PETScMatrix :: SetVariableBlockSizes (shared_ptr<ngs::FESpace> fes)
+  {
+    col_map->SetVariableBlockSizes(fes);
+    if (row_map != col_map)
+      { row_map->SetVariableBlockSizes(fes); }
+    ApplyVariableBlockSizes();
+  } // PETScMatrix::SetVariableBlockSizes
+
+
+  void PETScMatrix :: ApplyVariableBlockSizes ()
+  {
+    auto vbs = col_map->GetVariableBlockSizes();
+    if ( (vbs.Size() == 0) || (row_map->GetNRowsLocal() != col_map->GetNRowsLocal()) )
+      { return; }
+    // (a copy, older PETSc versions take PetscInt* instead of const PetscInt*)
+    Array<PetscInt> bsizes(vbs.Size());
+    bsizes = vbs;
+    MatSetVariableBlockSizes(petsc_mat, bsizes.Size(), bsizes.Data());
+  } // PETScMatrix::ApplyVariableBlockSizes
+
+
+  void PETScMatrix :: SetSPD (bool spd)
+  {
+    MatSetOption(petsc_mat, MAT_SPD, spd ? PETSC_TRUE : PETSC_FALSE);
+    if (spd) {
+      MatSetOption(petsc_mat, MAT_SYMMETRIC, PETSC_TRUE);
+      MatSetOption(petsc_mat, MAT_SYMMETRY_ETERNAL, PETSC_TRUE);
+    }
+  } // PETScMatrix::SetSPD
+
+
+  /**
+     Takes the place of the NGSolve matrix after PETScMatrix::ReleaseNGsMatrix: same sizes, vectors
+     and parallel dofs, products are computed by PETSc (rows/cols not in the subsets give zeros).
+  **/
+  class ReleasedNGsMatrix : public ngs::BaseMatrix
+  {
+  public:
+    ReleasedNGsMatrix (shared_ptr<ngs::BaseMatrix> ngs_mat, PETScMat _petsc_mat,
+		       shared_ptr<NGs2PETScVecMap> _row_map, shared_ptr<NGs2PETScVecMap> _col_map)
+      : BaseMatrix(ngs_mat->GetParallelDofs()), petsc_mat(_petsc_mat), row_map(_row_map), col_map(_col_map),
+	h(ngs_mat->VHeight()), w(ngs_mat->VWidth()), is_complex(ngs_mat->IsComplex())
+    {
+      ReferencePETScObject((PetscObject)_petsc_mat);
+      petsc_x = row_map->CreatePETScVector();
+      petsc_y = col_map->CreatePETScVector();
+    }
+
+    virtual int VHeight () const override { return h; }
+    virtual int VWidth () const override { return w; }
+    virtual bool IsComplex () const override { return is_complex; }
+    virtual ngs::AutoVector CreateRowVector () const override { return row_map->CreateNGsVector(); }
+    virtual ngs::AutoVector CreateColVector () const override { return col_map->CreateNGsVector(); }
+
+    virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override
+    {
+      static ngs::Timer t("ReleasedNGsMatrix::Mult"); ngs::RegionTimer rt(t);
+      row_map->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_x);
+      MatMult(petsc_mat, petsc_x, petsc_y);
+      col_map->PETSc2NGs(y, petsc_y);
+    }
+
+  protected:
+    PETScHandle<PETScMat> petsc_mat;
+    shared_ptr<NGs2PETScVecMap> row_map, col_map;
+    PETScHandle<PETScVec> petsc_x, petsc_y;
+    int h, w;
+    bool is_complex;
+  };
+
+
+  void PETScMatrix :: ReleaseNGsMatrix ()
+  {
+    if (released)
+      { return; }
+    if (aliased)
+      { throw Exception("PETScMatrix shares its values with the NGSolve matrix (zero_copy), can not release it!"); }
+    ngs_mat = make_shared<ReleasedNGsMatrix>(ngs_mat, GetPETScMat(), GetRowMap(), GetColMap());
+    conv_rowptr.SetSize0(); conv_cols.SetSize0(); conv_src.SetSize0();
+    plan = UpdatePlan();
+    released = true;
+  } // PETScMatrix::ReleaseNGsMatrix
+
+
+  void PETScMatrix :: CreateInterleavedMatrix ()
+  {
+    static ngs::Timer t("PETScMatrix::CreateInterleavedMatrix"); ngs::RegionTimer rt(t);
+
+    if ( (row_map == nullptr) || (col_map == nullptr) || !row_map->IsInterleaved() || !col_map->IsInterleaved() ||
+	 (row_map->GetBS() != col_map->GetBS()) )
+      { throw Exception("PETScMatrix: interleaved conversion needs interleaved row- and column maps with the same block size!"); }
+
+    auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+    auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>( (parmat == nullptr) ? ngs_mat : parmat->GetMatrix() );
+    if (spmat == nullptr)
+      { throw Exception("PETScMatrix: interleaved conversion needs a scalar sparse matrix!"); }
+    conv_symmetric = dynamic_pointer_cast<ngs::SparseMatrixSymmetric<PETScScalar>>(spmat) != nullptr;
+
+    // height ~ col_map, width ~ row_map
+    const int N = row_map->GetBS();
+    const size_t nr = col_map->GetNDof(), nc = row_map->GetNDof();
+    if ( (spmat->Height() != N * nr) || (spmat->Width() != N * nc) )
+      { throw Exception("PETScMatrix: matrix does not fit to the interleaved maps!"); }
+    if (N < 2)
+      { throw Exception("PETScMatrix: can not interleave with block size " + ToString(N)); }
+
+    // the conversion works on the nodes
+    row_subset = row_map->GetSubSet();
+    col_subset = col_map->GetSubSet();
+    Array<int> row_compress, col_compress;
+    conv_ncols = CompressSubSet(nc, row_subset, row_compress);
+    int nbrows = CompressSubSet(nr, col_subset, col_compress);
+
+    shared_ptr<ngs::ParallelDofs> pdrow = nullptr, pdcol = nullptr;
+    if ( (parmat != nullptr) && (parmat->GetOpType() == ngs::PARALLEL_OP::C2C) )
+      { pdrow = row_map->GetParallelDofs(); pdcol = col_map->GetParallelDofs(); }
+
+    // node graph, symmetric matrices in full (TableCreator::Add is thread safe)
+    ngs::TableCreator<int> creator(nr);
+    for ( ; !creator.Done(); creator++)
+      ParallelForRange (Range(spmat->Height()), [&] (auto rr) {
+	  for (auto r : rr) {
+	    for (auto c : spmat->GetRowIndices(r)) {
+	      creator.Add(r % nr, c % nc);
+	      if (conv_symmetric && (c != int(r)))
+		{ creator.Add(c % nr, r % nc); }
+	    }
+	    if (nr == nc) // diagonal, for entries not in the subset
+	      { creator.Add(r % nr, r % nc); }
+	  }
+	});
+    auto graph = creator.MoveTable();
+
+    // sorted, unique and compressed block columns, C2C duplicates are left out
+    Array<PETScInt> nbr(nbrows);
+    n_filtered = 0;
+    ParallelForRange (Range(nr), [&] (auto rr) {
+	size_t nf = 0;
+	for (auto k : rr) {
+	  if (col_compress[k] == -1) continue;
+	  auto row = graph[k];
+	  QuickSort(row);
+	  size_t cnt = 0;
+	  int prev = -1;
+	  for (auto j : Range(row)) {
+	    int c = row[j];
+	    if ( (c == prev) || (row_compress[c] == -1) ) continue;
+	    prev = c;
+	    if (!KeepC2CEntry(pdrow, pdcol, k, c))
+	      { nf += N * N; continue; }
+	    row[cnt++] = row_compress[c];
+	  }
+	  nbr[col_compress[k]] = cnt;
+	}
+	AsAtomic(n_filtered) += nf;
+      });
+    conv_rowptr.SetSize(nbrows + 1);
+    conv_rowptr[0] = 0;
+    for (auto k : Range(nbrows))
+      { conv_rowptr[k+1] = conv_rowptr[k] + nbr[k]; }
+    conv_cols.SetSize(conv_rowptr[nbrows]);
+    ParallelForRange (Range(nr), [&] (auto rr) {
+	for (auto k : rr) {
+	  int kr = col_compress[k];
+	  if (kr == -1) continue;
+	  for (auto j : Range(nbr[kr]))
+	    { conv_cols[conv_rowptr[kr] + j] = graph[k][j]; }
+	}
+      });
+
+    // position of value (r, c) in the SEQBAIJ values, blocks are stored column-major
+    const size_t NONE = size_t(-1);
+    auto pos = [&](size_t r, size_t c) -> size_t {
+      int kr = col_compress[r % nr], kc = row_compress[c % nc];
+      if ( (kr == -1) || (kc == -1) )
+	{ return NONE; }
+      auto beg = conv_cols.Data() + conv_rowptr[kr], end = conv_cols.Data() + conv_rowptr[kr+1];
+      auto it = std::lower_bound(beg, end, PETScInt(kc));
+      if ( (it == end) || (*it != kc) ) // (C2C duplicate)
+	{ return NONE; }
+      return size_t(N * N) * (it - conv_cols.Data()) + (r / nr) + N * (c / nc);
+    };
+
+    auto entry_rss = row_map->GetEntrySubSet(), entry_css = col_map->GetEntrySubSet();
+    auto in_rss = [&](size_t c) { return (entry_rss == nullptr) || entry_rss->Test(c); };
+    auto in_css = [&](size_t r) { return (entry_css == nullptr) || entry_css->Test(r); };
+
+    // values: -1 -> zero, -2 -> 1 on the diagonal of entries not in the subset;
+    // every value has at most one source, so threads never write the same position
+    conv_src.SetSize(N * N * conv_cols.Size());
+    conv_src = NONE;
+    auto set_src = [&](size_t r, size_t c, size_t src) {
+      if (in_css(r) && in_rss(c)) {
+	size_t p = pos(r, c);
+	if (p != NONE)
+	  { conv_src[p] = src; }
+      }
+    };
+    ParallelForRange (Range(spmat->Height()), [&] (auto rr) {
+	for (auto r : rr) {
+	  auto cols = spmat->GetRowIndices(r);
+	  size_t first = spmat->First(r);
+	  for (auto j : Range(cols)) {
+	    set_src(r, cols[j], first + j);
+	    if (conv_symmetric && (cols[j] != int(r)))
+	      { set_src(cols[j], r, first + j); }
+	  }
+	  if (!in_css(r) && (nr == nc)) {
+	    size_t p = pos(r, r);
+	    if (p != NONE)
+	      { conv_src[p] = size_t(-2); }
+	  }
+	}
+      });
+
+    interleaved = true;
+
+    PETScMat petsc_mat_loc = CreateInterleavedLocalMat();
+    if (parmat != nullptr) {
+      petsc_mat = CreatePETScMatIS(petsc_mat_loc, row_map, col_map);
+      MatDestroy(&petsc_mat_loc); // the MATIS holds a reference
+      // (conversions to SBAIJ want to know)
+      if (conv_symmetric)
+	{ MatSetOption(petsc_mat, MAT_SYMMETRIC, PETSC_TRUE); }
+    }
+    else
+      { petsc_mat = petsc_mat_loc; }
+  } // PETScMatrix::CreateInterleavedMatrix
+
+
+  PETScMat PETScMatrix :: CreateInterleavedLocalMat () const
+  {
+    const int N = row_map->GetBS();
+    PETScInt nbrows = conv_rowptr.Size() - 1;
+
+    PETScMat loc_mat;
+    MatCreate(PETSC_COMM_SELF, &loc_mat);
+    MatSetSizes(loc_mat, N * nbrows, N * conv_ncols, N * nbrows, N * conv_ncols);
+    MatSetType(loc_mat, MATSEQBAIJ);
+    MatSeqBAIJSetPreallocationCSR(loc_mat, N, conv_rowptr.Data(), conv_cols.Data(), NULL); // (values are zero)
+    if (conv_symmetric)
+      { MatSetOption(loc_mat, MAT_SYMMETRIC, PETSC_TRUE); }
+    SetInterleavedValues(loc_mat);
+    return loc_mat;
+  } // PETScMatrix::CreateInterleavedLocalMat
+
+
+  void PETScMatrix :: SetInterleavedValues (PETScMat loc_mat) const
+  {
+    static ngs::Timer t("PETScMatrix::SetInterleavedValues"); ngs::RegionTimer rt(t);
+
+    auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+    auto spmat = dynamic_pointer_cast<ngs::BaseSparseMatrix>( (parmat == nullptr) ? ngs_mat : parmat->GetMatrix() );
+    const PETScScalar * sv = spmat->AsVector().FV<PETScScalar>().Data();
+    PETScScalar * bv;
+    MatSeqBAIJGetArray(loc_mat, &bv);
+    ParallelForRange (Range(conv_src.Size()), [&] (auto r) {
+	for (auto k : r) {
+	  size_t src = conv_src[k];
+	  bv[k] = (src == size_t(-1)) ? PETScScalar(0) : ( (src == size_t(-2)) ? PETScScalar(1) : sv[src] );
+	}
+      });
+    MatSeqBAIJRestoreArray(loc_mat, &bv);
+    PetscObjectStateIncrease((PetscObject)loc_mat);
+  } // PETScMatrix::SetInterleavedValues
+
+
+  void PETScMatrix :: UpdateInterleavedValues ()
+  {
+    static ngs::Timer t("PETScMatrix::UpdateInterleavedValues"); ngs::RegionTimer rt(t);
+
+    /**
+       The SEQBAIJ (also as local matrix of a MATIS) gets the values directly. If the constructor has
+       converted it to another format, the values go through a temporary SEQBAIJ and MatConvert.
+    **/
+    PETScMatType pmt; MatGetType(petsc_mat, &pmt);
+    if (string(pmt) == string(MATIS)) {
+      PETScMat loc_mat;
+      MatISGetLocalMat(petsc_mat, &loc_mat);
+      PETScMatType mt; MatGetType(loc_mat, &mt);
+      if (string(mt) == string(MATSEQBAIJ))
+	{ SetInterleavedValues(loc_mat); }
+      else {
+	PETScMat tmp_mat = CreateInterleavedLocalMat();
+	MatConvert(tmp_mat, mt, MAT_REUSE_MATRIX, &loc_mat);
+	MatDestroy(&tmp_mat);
+      }
+      MatISRestoreLocalMat(petsc_mat, &loc_mat);
+      PetscObjectStateIncrease((PetscObject)GetPETScMat());
+    }
+    else if (string(pmt) == string(MATSEQBAIJ))
+      { SetInterleavedValues(petsc_mat); }
+    else {
+      PETScMat tmp_mat = CreateInterleavedLocalMat();
+      if (dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat) != nullptr) {
+	PETScMat tmp_loc = tmp_mat;
+	tmp_mat = CreatePETScMatIS(tmp_loc, row_map, col_map);
+	MatDestroy(&tmp_loc);
+      }
+      MatConvert(tmp_mat, pmt, MAT_REUSE_MATRIX, &petsc_mat.Get());
+      MatDestroy(&tmp_mat);
+    }
+  } // PETScMatrix::UpdateInterleavedValues
+
+
+  void PETScMatrix :: ConvertMat (bool sbaij)
   {
 
     static ngs::Timer t("PETScMatrix::ConvertMat"); ngs::RegionTimer rt(t);
@@ -698,9 +2116,34 @@ namespace ngs_petsc_interface
     if (!spmat) { throw Exception("Can only convert Sparse Matrices to PETSc."); }
 
     // local PETSc matrix
-    PETScMat petsc_mat_loc = CreatePETScMatSeq(spmat, row_subset, col_subset);
+    PETScMat petsc_mat_loc = NULL;
+    bool c2c = (parmat != nullptr) && (parmat->GetOpType() == ngs::PARALLEL_OP::C2C);
+    if ( conv_opts.zero_copy && !sbaij && (row_subset == nullptr) && (col_subset == nullptr) && !c2c ) {
+      // (C2C would write zeros into the NGSolve-matrix)
+      petsc_mat_loc = CreatePETScMatSeqAIJAlias(spmat, alias_rowptr);
+      aliased = petsc_mat_loc != NULL;
+    }
+    if (sbaij) {
+      bool same_subsets = (row_subset == col_subset);
+      if ( !same_subsets && row_subset && col_subset && (row_subset->Size() == col_subset->Size()) ) {
+	same_subsets = true;
+	for (auto k : Range(row_subset->Size()))
+	  if (row_subset->Test(k) != col_subset->Test(k))
+	    { same_subsets = false; break; }
+      }
+      if ( !same_subsets || (row_pardofs != col_pardofs) )
+	{ throw Exception("SBAIJ format needs the same row- and column space!"); }
+    }
+    // the C2C-filter is part of the bulk conversion, only the old path needs DeleteDuplicateValues
+    bool filter_in_build = c2c && (sbaij || conv_opts.bulk_csr);
+    if (petsc_mat_loc == NULL) {
+      petsc_mat_loc = CreatePETScMatSeq(spmat, row_subset, col_subset, sbaij,
+					filter_in_build ? row_pardofs : nullptr, filter_in_build ? col_pardofs : nullptr, conv_opts, n_filtered);
+    }
+    if (petsc_mat_loc == NULL)
+      { throw Exception("Can not convert this kind of sparse matrix to PETSc!"); }
 
-    if (parmat && (parmat->GetOpType() == ngs::PARALLEL_OP::C2C))
+    if (c2c && !filter_in_build)
       { DeleteDuplicateValues(petsc_mat_loc, spmat, row_pardofs, col_pardofs, row_subset, col_subset); }
     
     PETScInt bs; MatGetBlockSize(petsc_mat_loc, &bs);
@@ -712,33 +2155,206 @@ namespace ngs_petsc_interface
       { col_map = make_shared<NGs2PETScVecMap>(spmat->Height(), bs, col_pardofs, col_subset); }
 
     // parallel PETSc matrix
-    petsc_mat = parallel ? CreatePETScMatIS (petsc_mat_loc, row_map, col_map) : petsc_mat_loc;
+    if (parallel) {
+      petsc_mat = CreatePETScMatIS (petsc_mat_loc, row_map, col_map);
+      MatDestroy(&petsc_mat_loc); // the MATIS holds a reference
+    }
+    else
+      { petsc_mat = petsc_mat_loc; }
 
   } // PETScMatrix::ConvertMat()
 
 
+  bool PETScMatrix :: ConvertMatCOO (bool allow_blocks)
+  {
+    auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+    // (the COO index arrays are larger than the matrix itself)
+    if ( (parmat == nullptr) || !conv_opts.coo || (conv_opts.mem_budget > 0) )
+      { return false; }
+
+    static ngs::Timer t("PETScMatrix::ConvertMatCOO"); ngs::RegionTimer rt(t);
+
+    auto row_pardofs = parmat->GetRowParallelDofs();
+    auto col_pardofs = parmat->GetColParallelDofs();
+    shared_ptr<ngs::ParallelDofs> pdrow = nullptr, pdcol = nullptr;
+    if (parmat->GetOpType() == ngs::PARALLEL_OP::C2C)
+      { pdrow = row_pardofs; pdcol = col_pardofs; }
+
+    auto mat = parmat->GetMatrix();
+    Array<PETScInt> coo_i, coo_j;
+    int bs = 0;
+    Iterate<MAX_SYS_DIM>([&](auto n) {
+	constexpr int N = 1 + n;
+	auto build = [&](auto spm) {
+	  bs = N;
+	  if (!row_map)
+	    { row_map = make_shared<NGs2PETScVecMap>(spm->Width(), bs, row_pardofs, row_subset); }
+	  if (!col_map)
+	    { col_map = make_shared<NGs2PETScVecMap>(spm->Height(), bs, col_pardofs, col_subset); }
+	  BuildCOOTM(spm, row_map->GetDOFMap(), col_map->GetDOFMap(), pdrow, pdcol, coo_i, coo_j, plan.src, n_filtered);
+	};
+	if constexpr(N==1) {
+	    if (auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat))
+	      { build(spm); }
+	  }
+	else {
+	  auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<ngs::Mat<N, N, PETScScalar>>>(mat);
+	  if (allow_blocks && spm)
+	    { build(spm); }
+	}
+      });
+    if (bs == 0)
+      { return false; }
+
+    MatCreate(parmat->GetRowParallelDofs()->GetCommunicator(), &petsc_mat.Get());
+    MatSetSizes(petsc_mat, col_map->GetNRowsLocal(), row_map->GetNRowsLocal(),
+		col_map->GetNRowsGlobal(), row_map->GetNRowsGlobal());
+    MatSetBlockSize(petsc_mat, bs);
+    MatSetType(petsc_mat, MATMPIAIJ);
+    MatSetPreallocationCOO(petsc_mat, PetscCount(coo_i.Size()), coo_i.Data(), coo_j.Data());
+
+    plan.coo = true;
+    plan.bs = 1;
+    plan.buffer.SetSize(plan.src.Size());
+    plan.valid = true;
+    ApplyUpdatePlan(petsc_mat, plan, *mat);
+
+    // we only need the values-map for updates
+    if (!conv_opts.cached_update)
+      { plan = UpdatePlan(); }
+
+    return true;
+  } // PETScMatrix::ConvertMatCOO
+
+
+  void PETScMatrix :: CheckAlias ()
+  {
+    if (!aliased)
+      { return; }
+    // the alias only survives if we did not convert to some other format
+    PETScMatType pmt;
+    MatGetType(petsc_mat, &pmt);
+    if (string(pmt) == string(MATIS)) {
+      PETScMat loc_mat;
+      MatISGetLocalMat(petsc_mat, &loc_mat);
+      MatGetType(loc_mat, &pmt);
+      MatISRestoreLocalMat(petsc_mat, &loc_mat);
+    }
+    if (string(pmt) != string(MATSEQAIJ)) {
+      aliased = false;
+      alias_rowptr.SetSize0();
+    }
+  } // PETScMatrix::CheckAlias
+
+
+  void PETScMatrix :: BuildUpdatePlan ()
+  {
+    if (plan.coo) // already done in ConvertMatCOO
+      { return; }
+    plan = UpdatePlan();
+    // (interleaved matrices have their own values-map)
+    if ( aliased || interleaved || !conv_opts.cached_update )
+      { return; }
+
+    static ngs::Timer t("PETScMatrix::BuildUpdatePlan"); ngs::RegionTimer rt(t);
+
+    auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+    shared_ptr<BaseMatrix> mat = (parmat == nullptr) ? ngs_mat : parmat->GetMatrix();
+    shared_ptr<ngs::ParallelDofs> pdrow = nullptr, pdcol = nullptr;
+    if ( (parmat != nullptr) && (parmat->GetOpType() == ngs::PARALLEL_OP::C2C) ) {
+      pdrow = parmat->GetRowParallelDofs();
+      pdcol = parmat->GetColParallelDofs();
+    }
+
+    // only sequential matrices, MPIAIJ/MPIBAIJ are updated with SetPETScMatPar
+    PETScMatType pmt; MatGetType(petsc_mat, &pmt);
+    bool is_matis = string(pmt) == string(MATIS);
+    PETScMat loc_mat = petsc_mat;
+    if (is_matis)
+      { MatISGetLocalMat(petsc_mat, &loc_mat); }
+
+    Iterate<MAX_SYS_DIM>([&](auto n) {
+	constexpr int N = 1 + n;
+	if constexpr(N==1) {
+	    if (auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat))
+	      { BuildUpdatePlanTM(loc_mat, spmat, row_subset, col_subset, pdrow, pdcol, plan); }
+	  }
+	else {
+	  if (auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<ngs::Mat<N, N, PETScScalar>>>(mat))
+	    { BuildUpdatePlanTM(loc_mat, spmat, row_subset, col_subset, pdrow, pdcol, plan); }
+	}
+      });
+
+    if (is_matis)
+      { MatISRestoreLocalMat(petsc_mat, &loc_mat); }
+  } // PETScMatrix::BuildUpdatePlan
+
+
   void PETScMatrix :: UpdateValues ()
   {
     static ngs::Timer t("PETScMatrix::UpdateValues"); ngs::RegionTimer rt(t);
 
+    if (released)
+      { throw Exception("PETScMatrix::UpdateValues after ReleaseNGsMatrix, there are no NGSolve values to take!"); }
+
+    if (interleaved) {
+      UpdateInterleavedValues();
+      return;
+    }
+
+    if (aliased) {
+      // PETSc already sees the new values, we only have to tell it that they have changed
+      PetscObjectStateIncrease((PetscObject)GetPETScMat());
+      PETScMatType pmt; MatGetType(petsc_mat, &pmt);
+      if (string(pmt) == string(MATIS)) {
+	PETScMat loc_mat;
+	MatISGetLocalMat(petsc_mat, &loc_mat);
+	PetscObjectStateIncrease((PetscObject)loc_mat);
+	MatISRestoreLocalMat(petsc_mat, &loc_mat);
+      }
+      return;
+    }
+
+    if (plan.valid) {
+      // (MATIS local matrix, sequential matrix or MPIAIJ from COO)
+      auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
+      shared_ptr<BaseMatrix> mat = (parmat == nullptr) ? ngs_mat : parmat->GetMatrix();
+      PETScMatType pmt; MatGetType(petsc_mat, &pmt);
+      if (string(pmt) == string(MATIS)) {
+	PETScMat loc_mat;
+	MatISGetLocalMat(petsc_mat, &loc_mat);
+	ApplyUpdatePlan(loc_mat, plan, *mat);
+	MatISRestoreLocalMat(petsc_mat, &loc_mat);
+	PetscObjectStateIncrease((PetscObject)GetPETScMat());
+      }
+      else
+	{ ApplyUpdatePlan(petsc_mat, plan, *mat); }
+      return;
+    }
+
     // If we have converted the matrix from BAIJ to AIJ, is SetValuesBlocked inefficient??
     // SZ: answer: it shouldn't be inefficient: it expands by blocksize
     // the blocked set of indices and then call MatSetValues (thanks Stefano!)
     auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat);
     shared_ptr<BaseMatrix> mat = (parmat == nullptr) ? ngs_mat : parmat->GetMatrix();
+    shared_ptr<ngs::ParallelDofs> pdrow = nullptr, pdcol = nullptr;
+    if ( (parmat != nullptr) && (parmat->GetOpType() == ngs::PARALLEL_OP::C2C) ) {
+      pdrow = parmat->GetRowParallelDofs();
+      pdcol = parmat->GetColParallelDofs();
+    }
 
     bool update_done = false;
     Iterate<MAX_SYS_DIM>([&](auto n) {
 	constexpr int N = 1 + n;
 	if constexpr(N==1) {
 	    if (auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat)) {
-	      SetPETScMat (petsc_mat, spmat, GetRowMap(), GetColMap());
+	      SetPETScMat (petsc_mat, spmat, GetRowMap(), GetColMap(), pdrow, pdcol);
 	      update_done = true;
 	    }
 	  }
 	else {
 	  if (auto spmat = dynamic_pointer_cast<ngs::SparseMatrixTM<ngs::Mat<N, N, PETScScalar>>>(mat)) {
-	    SetPETScMat (petsc_mat, spmat, GetRowMap(), GetColMap());
+	    SetPETScMat (petsc_mat, spmat, GetRowMap(), GetColMap(), pdrow, pdcol);
 	    update_done = true;
 	  }
 	}
@@ -805,12 +2421,15 @@ namespace ngs_petsc_interface
     // cout << "nrows " << row_map->GetNRowsLocal() << " " << col_map->GetNRowsLocal() << " " << row_map->GetNRowsGlobal() << " " << col_map->GetNRowsGlobal() << endl;
     // if (row_pardofs != nullptr)
     //   { cout << "pardof- ndofs " << row_pardofs->GetNDofLocal() << " " << row_pardofs->GetNDofGlobal() << " " << col_pardofs->GetNDofLocal() << " " << col_pardofs->GetNDofGlobal() << endl; }
-    MatCreateShell (comm, row_map->GetNRowsLocal(), col_map->GetNRowsLocal(), row_map->GetNRowsGlobal(), col_map->GetNRowsGlobal(), (void*) this, &petsc_mat);
+    MatCreateShell (comm, row_map->GetNRowsLocal(), col_map->GetNRowsLocal(), row_map->GetNRowsGlobal(), col_map->GetNRowsGlobal(), (void*) this, &petsc_mat.Get());
 
     /** Set function pointers **/
     
     // MatMult: y = A * x
     MatShellSetOperation(petsc_mat, MATOP_MULT, (void(*)(void)) this->MatMult);
+
+    // C = A * B, for dense B and C (for block Krylov methods, KSPMatSolve)
+    MatShellSetMatProductOperation(petsc_mat, MATPRODUCT_AB, NULL, this->MatMatMult, NULL, MATDENSE, MATDENSE);
     
   } // FlatPETScMatrix
 
@@ -824,6 +2443,19 @@ namespace ngs_petsc_interface
     void* ptr; MatShellGetContext(A, &ptr);
     auto& FPM = *( (FlatPETScMatrix*) ptr);
 
+    auto row_map = FPM.GetRowMap(), col_map = FPM.GetColMap();
+    if (row_map->IsIdentity() && col_map->IsIdentity()) {
+      // work directly on the PETSc arrays
+      const PETScScalar * xs; VecGetArrayRead(x, &xs);
+      PETScScalar * ys; VecGetArray(y, &ys);
+      ngs::S_BaseVectorPtr<PETScScalar> xv(row_map->GetNDof(), row_map->GetBS(), const_cast<PETScScalar*>(xs));
+      ngs::S_BaseVectorPtr<PETScScalar> yv(col_map->GetNDof(), col_map->GetBS(), ys);
+      FPM.ngs_mat->Mult(xv, yv);
+      VecRestoreArray(y, &ys);
+      VecRestoreArrayRead(x, &xs);
+      return PetscErrorCode(0);
+    }
+
     FPM.GetRowMap()->PETSc2NGs (*FPM.row_hvec, x);
 
     FPM.ngs_mat->Mult(*FPM.row_hvec, *FPM.col_hvec);
@@ -834,6 +2466,187 @@ namespace ngs_petsc_interface
   } // FlatPETScMatrix::MatMult
 
 
+  PetscErrorCode FlatPETScMatrix :: MatMatMult (PETScMat A, PETScMat B, PETScMat C, void * data)
+  {
+    static ngs::Timer t("FlatPETScMatrix MatMatMult"); ngs::RegionTimer rt(t);
+
+    void* ptr; MatShellGetContext(A, &ptr);
+    auto& FPM = *( (FlatPETScMatrix*) ptr);
+
+    FPM.MultDense(B, C);
+
+    return PetscErrorCode(0);
+  } // FlatPETScMatrix::MatMatMult
+
+
+  void FlatPETScMatrix :: MultDense (PETScMat X, PETScMat Y)
+  {
+    static ngs::Timer t("FlatPETScMatrix::MultDense"); ngs::RegionTimer rt(t);
+
+    PETScInt ncols; MatGetSize(X, NULL, &ncols);
+    while (row_hvecs.Size() < size_t(ncols)) {
+      row_hvecs.Append(shared_ptr<ngs::BaseVector>(ngs_mat->CreateRowVector()));
+      col_hvecs.Append(shared_ptr<ngs::BaseVector>(ngs_mat->CreateColVector()));
+    }
+    auto xs = row_hvecs.Range(size_t(0), size_t(ncols)), ys = col_hvecs.Range(size_t(0), size_t(ncols));
+
+    GetRowMap()->PETSc2NGs(xs, X);
+
+    // operators that implement MultiMultAdd (e.g. with one cumulate for all vectors) profit, others go column by column
+    // (BaseMatrix::MultiMultAdd takes std::vectors, not FlatArrays)
+    std::vector<shared_ptr<ngs::BaseVector>> vxs, vys;
+    for (auto k : Range(ncols)) {
+      *ys[k] = 0.0;
+      vxs.push_back(xs[k]);
+      vys.push_back(ys[k]);
+    }
+    ngs_mat->MultiMultAdd(1.0, vxs, vys);
+
+    GetColMap()->NGs2PETSc(ys, Y);
+  } // FlatPETScMatrix::MultDense
+
+
+#ifndef PETSC_USE_COMPLEX
+  template<int BS>
+  void FloatCSRMultAdd (double scal, FlatArray<PETScInt> rowptr, FlatArray<PETScInt> cols, FlatArray<float> vals,
+			const PETScScalar * x, PETScScalar * y)
+  {
+    constexpr int BS2 = BS * BS;
+    ParallelForRange (Range(rowptr.Size() - 1), [&] (auto r) {
+	for (auto k : r) {
+	  PETScScalar acc[BS];
+	  for (int a = 0; a < BS; a++)
+	    { acc[a] = 0; }
+	  for (auto p : Range(rowptr[k], rowptr[k+1])) {
+	    const float * block = &vals[BS2 * p];
+	    const PETScScalar * xj = x + BS * cols[p];
+	    for (int a = 0; a < BS; a++)
+	      for (int b = 0; b < BS; b++)
+		{ acc[a] += block[BS*a+b] * xj[b]; }
+	  }
+	  for (int a = 0; a < BS; a++)
+	    { y[BS*k+a] += scal * acc[a]; }
+	}
+      });
+  } // FloatCSRMultAdd
+
+
+  FloatSparseMatrix :: FloatSparseMatrix (shared_ptr<ngs::BaseMatrix> mat)
+  {
+    static ngs::Timer t("FloatSparseMatrix constructor"); ngs::RegionTimer rt(t);
+
+    bool done = false;
+    Iterate<MAX_SYS_DIM>([&](auto n) {
+	constexpr int N = 1 + n;
+	auto build = [&](auto spm) {
+	  bs = N; h = spm->Height(); w = spm->Width();
+	  Array<int> row_compress, col_compress;
+	  CompressSubSet(w, nullptr, row_compress);
+	  CompressSubSet(h, nullptr, col_compress);
+	  SeqCSRGraph graph;
+	  BuildSeqCSRGraph(spm, row_compress, col_compress, h, graph);
+	  vals.SetSize(N * N * graph.src.Size());
+	  FillSeqCSRValues(spm, graph, vals.Data());
+	  rowptr = std::move(graph.ia);
+	  cols = std::move(graph.ja);
+	  done = true;
+	};
+	if constexpr(N==1) {
+	    if (auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<PETScScalar>>(mat))
+	      { build(spm); }
+	  }
+	else {
+	  if (auto spm = dynamic_pointer_cast<ngs::SparseMatrixTM<ngs::Mat<N, N, PETScScalar>>>(mat))
+	    { build(spm); }
+	}
+      });
+    if (!done)
+      { throw Exception("FloatSparseMatrix needs a real SparseMatrix with square blocks!"); }
+  } // FloatSparseMatrix
+
+
+  ngs::AutoVector FloatSparseMatrix :: CreateRowVector () const
+  { return make_unique<ngs::S_BaseVectorPtr<PETScScalar>> (w, bs); }
+
+
+  ngs::AutoVector FloatSparseMatrix :: CreateColVector () const
+  { return make_unique<ngs::S_BaseVectorPtr<PETScScalar>> (h, bs); }
+
+
+  void FloatSparseMatrix :: MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const
+  {
+    static ngs::Timer t("FloatSparseMatrix::MultAdd"); ngs::RegionTimer rt(t);
+    const PETScScalar * xs = x.FV<PETScScalar>().Data();
+    PETScScalar * ys = y.FV<PETScScalar>().Data();
+    Iterate<MAX_SYS_DIM>([&](auto n) {
+	constexpr int N = 1 + n;
+	if (N == bs)
+	  { FloatCSRMultAdd<N>(scal, rowptr, cols, vals, xs, ys); }
+      });
+  } // FloatSparseMatrix::MultAdd
+
+
+  void FloatSparseMatrix :: GetDiagonal (PETScScalar * diag) const
+  {
+    ParallelForRange (Range(h), [&] (auto r) {
+	for (auto k : r) {
+	  for (int a = 0; a < bs; a++)
+	    { diag[bs*k+a] = 0; }
+	  for (auto p : Range(rowptr[k], rowptr[k+1]))
+	    if (cols[p] == PETScInt(k)) {
+	      for (int a = 0; a < bs; a++)
+		{ diag[bs*k+a] = vals[bs*bs*p + bs*a + a]; }
+	      break;
+	    }
+	}
+      });
+  } // FloatSparseMatrix::GetDiagonal
+
+
+  shared_ptr<ngs::BaseMatrix> FloatPETScMatrix :: CreateFloatMatrix (shared_ptr<ngs::BaseMatrix> mat)
+  {
+    if (auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(mat)) {
+      auto loc_mat = make_shared<FloatSparseMatrix>(parmat->GetMatrix());
+      return make_shared<ngs::ParallelMatrix>(loc_mat, parmat->GetRowParallelDofs(), parmat->GetColParallelDofs(), parmat->GetOpType());
+    }
+    return make_shared<FloatSparseMatrix>(mat);
+  } // FloatPETScMatrix::CreateFloatMatrix
+
+
+  FloatPETScMatrix :: FloatPETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
+					shared_ptr<ngs::BitArray> _col_subset, shared_ptr<NGs2PETScVecMap> _row_map,
+					shared_ptr<NGs2PETScVecMap> _col_map)
+    : FlatPETScMatrix(CreateFloatMatrix(_ngs_mat), _row_subset, _col_subset, _row_map, _col_map)
+  {
+    diag_status = ngs::DISTRIBUTED;
+    if (auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(ngs_mat)) {
+      float_mat = dynamic_pointer_cast<FloatSparseMatrix>(parmat->GetMatrix());
+      if (parmat->GetOpType() == ngs::PARALLEL_OP::C2C)
+	{ diag_status = ngs::CUMULATED; }
+    }
+    else
+      { float_mat = dynamic_pointer_cast<FloatSparseMatrix>(ngs_mat); }
+
+    MatShellSetOperation(petsc_mat, MATOP_GET_DIAGONAL, (void(*)(void)) this->GetDiagonal);
+  } // FloatPETScMatrix
+
+
+  PetscErrorCode FloatPETScMatrix :: GetDiagonal (PETScMat A, PETScVec d)
+  {
+    static ngs::Timer t("FloatPETScMatrix GetDiagonal"); ngs::RegionTimer rt(t);
+
+    void* ptr; MatShellGetContext(A, &ptr);
+    auto & FPM = static_cast<FloatPETScMatrix&>(*( (FlatPETScMatrix*) ptr));
+
+    FPM.float_mat->GetDiagonal(FPM.col_hvec->FV<PETScScalar>().Data());
+    FPM.col_hvec->SetParallelStatus(FPM.diag_status);
+    FPM.GetColMap()->NGs2PETSc(*FPM.col_hvec, d);
+
+    return PetscErrorCode(0);
+  } // FloatPETScMatrix::GetDiagonal
+#endif // PETSC_USE_COMPLEX
+
+
   MatNullSpace NullSpaceCreate (FlatArray<shared_ptr<ngs::BaseVector>> vecs, shared_ptr<NGs2PETScVecMap> map,
 				bool is_orthonormal, bool const_kernel)
   {
@@ -860,11 +2673,214 @@ namespace ngs_petsc_interface
     else
       { comm = PETSC_COMM_SELF; }
     MatNullSpace ns; MatNullSpaceCreate(comm, const_kernel ? PETSC_TRUE : PETSC_FALSE, vecs.Size(), &petsc_vecs[0], &ns);
-    for (auto v : petsc_vecs) // destroy vecs (reduces reference count by 1)
-      { /* VecDestroy(&v); */ }
+    for (auto & v : petsc_vecs) // the null space holds its own references
+      { VecDestroy(&v); }
     return ns;
   } // NullSpaceCreate
 
+
+  int H1NodeCoordinates (shared_ptr<ngs::FESpace> fes, bool vertices_only,
+			 Array<shared_ptr<ngs::BaseVector>> & xyz, Array<int> * entry_comp)
+  {
+    static ngs::Timer t("H1NodeCoordinates"); ngs::RegionTimer rt(t);
+
+    // components are either blocked in the dof (H1, dim=d) or consecutive ranges (VectorH1):
+    // DOF d of comp_spaces[k] is entry comp_first[k] + comp_stride * d
+    Array<shared_ptr<ngs::FESpace>> comp_spaces;
+    Array<size_t> comp_first;
+    size_t comp_stride = 1;
+    if (auto comp_fes = dynamic_pointer_cast<ngs::CompoundFESpace>(fes)) {
+      for (auto k : Range(comp_fes->GetNSpaces())) {
+	comp_spaces.Append((*comp_fes)[k]);
+	comp_first.Append(comp_fes->GetRange(k).First());
+      }
+    }
+    else {
+      comp_stride = fes->GetDimension();
+      for (auto k : Range(comp_stride)) {
+	comp_spaces.Append(fes);
+	comp_first.Append(k);
+      }
+    }
+    for (auto space : comp_spaces)
+      if ( (dynamic_pointer_cast<ngs::H1HighOrderFESpace>(space) == nullptr) ||
+	   ( (space != fes) && (space->GetDimension() != 1) ) )
+	{ return 0; }
+    int ncomp = comp_spaces.Size();
+
+    auto ma = fes->GetMeshAccess();
+    int mdim = ma->GetDimension();
+    xyz.SetSize(mdim);
+    Array<PETScScalar*> fvs(mdim);
+    for (auto k : Range(mdim)) {
+      if (fes->IsParallel())
+	{ xyz[k] = make_shared<ngs::S_ParallelBaseVectorPtr<PETScScalar>>(fes->GetNDof(), fes->GetDimension(), fes->GetParallelDofs(), ngs::CUMULATED); }
+      else
+	{ xyz[k] = make_shared<ngs::S_BaseVectorPtr<PETScScalar>>(fes->GetNDof(), fes->GetDimension()); }
+      auto fv = xyz[k]->FV<PETScScalar>();
+      fv = 0.0;
+      fvs[k] = fv.Data();
+    }
+    if (entry_comp != nullptr) {
+      entry_comp->SetSize(fes->GetNDof() * fes->GetDimension());
+      *entry_comp = -1;
+    }
+
+    auto set_node = [&](ngs::NodeId node, const ngs::Vec<3> & x, Array<ngs::DofId> & dnums) {
+      for (auto comp : Range(ncomp)) {
+	comp_spaces[comp]->GetDofNrs(node, dnums);
+	for (auto d : dnums) {
+	  if (d < 0)
+	    { continue; }
+	  size_t entry = comp_first[comp] + comp_stride * d;
+	  for (auto k : Range(mdim))
+	    { fvs[k][entry] = x(k); }
+	  if (entry_comp != nullptr)
+	    { (*entry_comp)[entry] = comp; }
+	}
+      }
+    };
+    auto get_point = [&](size_t vnr) {
+      ngs::Vec<3> x = 0.0;
+      if (mdim == 3) { x = ma->GetPoint<3>(vnr); }
+      else { auto p = ma->GetPoint<2>(vnr); x(0) = p(0); x(1) = p(1); }
+      return x;
+    };
+    auto center = [&](auto pnums) {
+      ngs::Vec<3> x = 0.0;
+      for (auto p : pnums)
+	{ x += get_point(p); }
+      return ngs::Vec<3>((1.0 / pnums.Size()) * x);
+    };
+
+    ngs::ParallelForRange(ma->GetNV(), [&](auto r) {
+	Array<ngs::DofId> dnums;
+	for (auto vnr : r)
+	  { set_node(ngs::NodeId(ngs::NT_VERTEX, vnr), get_point(vnr), dnums); }
+      });
+    if (!vertices_only) {
+      ngs::ParallelForRange(ma->GetNEdges(), [&](auto r) {
+	  Array<ngs::DofId> dnums;
+	  for (auto enr : r) {
+	    auto pnums = ma->GetEdgePNums(enr);
+	    set_node(ngs::NodeId(ngs::NT_EDGE, enr), ngs::Vec<3>(0.5 * (get_point(pnums[0]) + get_point(pnums[1]))), dnums);
+	  }
+	});
+      ngs::ParallelForRange(ma->GetNFaces(), [&](auto r) {
+	  Array<ngs::DofId> dnums;
+	  for (auto fnr : r)
+	    { set_node(ngs::NodeId(ngs::NT_FACE, fnr), center(ma->GetFacePNums(fnr)), dnums); }
+	});
+      if (mdim == 3) {
+	ngs::ParallelForRange(ma->GetNE(ngs::VOL), [&](auto r) {
+	    Array<ngs::DofId> dnums;
+	    for (auto elnr : r)
+	      { set_node(ngs::NodeId(ngs::NT_CELL, elnr), center(ma->GetElVertices(ngs::ElementId(ngs::VOL, elnr))), dnums); }
+	  });
+      }
+    }
+
+    // coordinates are consistent across ranks
+    for (auto & x : xyz)
+      { x->SetParallelStatus(ngs::CUMULATED); }
+
+    return ncomp;
+  } // H1NodeCoordinates
+
+
+  MatNullSpace RigidBodyNullSpaceCreate (shared_ptr<ngs::FESpace> fes, shared_ptr<NGs2PETScVecMap> map, bool vector_only)
+  {
+    static ngs::Timer t("RigidBodyNullSpaceCreate"); ngs::RegionTimer rt(t);
+
+    // the modes are linear, so for the hierarchical H1 basis only vertex-dofs are non-zero
+    Array<shared_ptr<ngs::BaseVector>> xyz;
+    Array<int> entry_comp;
+    int ncomp = H1NodeCoordinates(fes, true, xyz, &entry_comp);
+    if (ncomp == 0)
+      { return nullptr; }
+
+    int mdim = xyz.Size();
+    if (vector_only && (ncomp != mdim))
+      { return nullptr; }
+    int nrot = (ncomp != mdim) ? 0 : ( (mdim == 2) ? 1 : ( (mdim == 3) ? 3 : 0 ) );
+
+    Array<shared_ptr<ngs::BaseVector>> modes(ncomp + nrot);
+    Array<PETScScalar*> fvs(modes.Size());
+    for (auto k : Range(modes.Size())) {
+      modes[k] = shared_ptr<ngs::BaseVector>(map->CreateNGsVector());
+      auto fv = modes[k]->FV<PETScScalar>();
+      fv = 0.0;
+      fvs[k] = fv.Data();
+    }
+    Array<const PETScScalar*> xs(mdim);
+    for (auto k : Range(mdim))
+      { xs[k] = xyz[k]->FV<PETScScalar>().Data(); }
+
+    // rotations (-y,x,0), (0,-z,y), (z,0,-x)
+    const int rot_comps[3][2] = { {0, 1}, {1, 2}, {2, 0} };
+    ngs::ParallelForRange(entry_comp.Size(), [&](auto r) {
+	for (auto row : r) {
+	  int comp = entry_comp[row];
+	  if (comp == -1)
+	    { continue; }
+	  fvs[comp][row] = 1.0;
+	  for (auto l : Range(nrot)) {
+	    if (comp == rot_comps[l][0])
+	      { fvs[ncomp + l][row] = -xs[rot_comps[l][1]][row]; }
+	    else if (comp == rot_comps[l][1])
+	      { fvs[ncomp + l][row] = xs[rot_comps[l][0]][row]; }
+	  }
+	}
+      });
+
+    // coordinates are consistent across ranks, so the modes are cumulated
+    for (auto & mode : modes)
+      { mode->SetParallelStatus(ngs::CUMULATED); }
+
+    return NullSpaceCreate(modes, map, false, false);
+  } // RigidBodyNullSpaceCreate
+
+
+  int RowCoordinatesCreate (shared_ptr<ngs::FESpace> fes, shared_ptr<NGs2PETScVecMap> map, Array<PetscReal> & coords,
+			    bool vertices_only)
+  {
+    static ngs::Timer t("RowCoordinatesCreate"); ngs::RegionTimer rt(t);
+
+    Array<shared_ptr<ngs::BaseVector>> xyz;
+    Array<int> entry_comp;
+    if (H1NodeCoordinates(fes, vertices_only, xyz, &entry_comp) == 0)
+      { return 0; }
+    int mdim = xyz.Size();
+
+    size_t nrows = map->GetNRowsLocal();
+    PETScVec pvec = map->CreatePETScVector();
+
+    // with vertices_only, give up if any PETSc row (on any rank) is not a vertex-DOF
+    if (vertices_only) {
+      shared_ptr<ngs::BaseVector> not_vertex(map->CreateNGsVector());
+      auto fv = not_vertex->FV<PETScScalar>();
+      for (auto entry : Range(entry_comp.Size()))
+	{ fv[entry] = (entry_comp[entry] == -1) ? 1.0 : 0.0; }
+      not_vertex->SetParallelStatus(ngs::CUMULATED);
+      map->NGs2PETSc(*not_vertex, pvec);
+      PetscReal nv_norm; VecNorm(pvec, NORM_INFINITY, &nv_norm); // (collective)
+      if (nv_norm != 0)
+	{ VecDestroy(&pvec); return 0; }
+    }
+
+    coords.SetSize(mdim * nrows);
+    for (auto k : Range(mdim)) {
+      map->NGs2PETSc(*xyz[k], pvec);
+      const PETScScalar * vals; VecGetArrayRead(pvec, &vals);
+      for (auto row : Range(nrows))
+	{ coords[mdim * row + k] = PetscRealPart(vals[row]); }
+      VecRestoreArrayRead(pvec, &vals);
+    }
+    VecDestroy(&pvec);
+
+    return mdim;
+  } // RowCoordinatesCreate
+
 } // namespace ngs_petsc_interface
 
 
@@ -896,7 +2912,10 @@ namespace ngs_petsc_interface {
       .def("NGs2PETSc", [&](shared_ptr<NGs2PETScVecMap> vmap, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->NGs2PETSc(*nvec, pvec.value); } )
       .def("AddNGs2PETSc", [&](shared_ptr<NGs2PETScVecMap> vmap, double scal, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->AddNGs2PETSc(scal, *nvec, pvec.value); } )
       .def("AddNGs2PETSc", [&](shared_ptr<NGs2PETScVecMap> vmap, ngs::Complex scal, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->AddNGs2PETSc(scal, *nvec, pvec.value); } )
-      .def("PETSc2NGs", [&](shared_ptr<NGs2PETScVecMap> vmap, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->PETSc2NGs(*nvec, pvec.value); } )
+      .def("PETSc2NGs", [&](shared_ptr<NGs2PETScVecMap> vmap, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec, bool cumulated)
+	   { vmap->PETSc2NGs(*nvec, pvec.value, cumulated ? ngs::CUMULATED : ngs::DISTRIBUTED); },
+	   py::arg("ngs_vec"), py::arg("petsc_vec"), py::arg("cumulated") = false,
+	   "cumulated: fill non-master DOFs from their master and return a CUMULATED vector")
       .def("AddPETSc2NGs", [&](shared_ptr<NGs2PETScVecMap> vmap, double scal, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->AddPETSc2NGs(scal, *nvec, pvec.value); } )
       .def("AddPETSc2NGs", [&](shared_ptr<NGs2PETScVecMap> vmap, ngs::Complex scal, shared_ptr<ngs::BaseVector> nvec, pbholder<PETScVec> pvec) { vmap->AddPETSc2NGs(scal, *nvec, pvec.value); } )
       .def("GetLGMap", [&](shared_ptr<NGs2PETScVecMap> & vmap) { return pbholder<ISLocalToGlobalMapping>(vmap->GetISMap()); })
@@ -923,12 +2942,26 @@ namespace ngs_petsc_interface {
       (m, "PETScBaseMatrix", "Can be used as an NGSolve- or as a PETSc- Matrix")
       .def("SetNullSpace", [](shared_ptr<PETScBaseMatrix> & mat, py::list py_kvecs) {
 	  Array<shared_ptr<ngs::BaseVector>> kvecs = makeCArray<shared_ptr<ngs::BaseVector>>(py_kvecs);
-	  mat->SetNullSpace(NullSpaceCreate(kvecs, mat->GetRowMap()));
+	  MatNullSpace ns = NullSpaceCreate(kvecs, mat->GetRowMap());
+	  mat->SetNullSpace(ns);
+	  MatNullSpaceDestroy(&ns);
 	}, py::arg("kvecs"))
       .def("SetNearNullSpace", [](shared_ptr<PETScBaseMatrix> & mat, py::list py_kvecs) {
 	  Array<shared_ptr<ngs::BaseVector>> kvecs = makeCArray<shared_ptr<ngs::BaseVector>>(py_kvecs);
-	  mat->SetNearNullSpace(NullSpaceCreate(kvecs, mat->GetRowMap()));
+	  MatNullSpace ns = NullSpaceCreate(kvecs, mat->GetRowMap());
+	  mat->SetNearNullSpace(ns);
+	  MatNullSpaceDestroy(&ns);
 	}, py::arg("kvecs"))
+      .def("SetNearNullSpace", [](shared_ptr<PETScBaseMatrix> & mat, shared_ptr<ngs::FESpace> fes) {
+	  MatNullSpace ns = RigidBodyNullSpaceCreate(fes, mat->GetRowMap());
+	  if (ns == nullptr)
+	    { throw Exception("Can only generate a near-nullspace for (Vector-)H1 spaces!"); }
+	  mat->SetNearNullSpace(ns);
+	  MatNullSpaceDestroy(&ns);
+	}, py::arg("fes"), docu_string(R"raw_string(
+Sets the constant (scalar spaces) or rigid body modes (vector-valued H1 spaces, dim = mesh dimension)
+computed from the vertex coordinates of the given FESpace as near-nullspace.
+)raw_string"))
 #ifdef PETSc4Py_INTERFACE
       .def("GetPETScMat", [](shared_ptr<PETScBaseMatrix> & mat) { return pbholder<PETScMat>(mat->GetPETScMat()); })
       .def("GetRowMap", [](shared_ptr<PETScBaseMatrix> & mat) { return mat->GetRowMap(); })
@@ -945,26 +2978,95 @@ The format to use for the PETSc matrix.
 AIJ     .. (parallel) sparse matrix
 BAIJ    .. (parallel) sparse block matrix
 IS_AIJ  .. sub-assembled diagonal blocks, blocks in sparse matrix format (same as AIJ if not parallel)
-IS_BAIJ .. sub-assembled diagonal blocks, blocks in sparse block matrix format (same as BAIJ if not parallel) )raw_string"))
+IS_BAIJ .. sub-assembled diagonal blocks, blocks in sparse block matrix format (same as BAIJ if not parallel)
+SBAIJ   .. (parallel) symmetric sparse block matrix, only the upper triangle is stored
+           (needs a symmetric NGSolve matrix and freedofs = row_freedofs = col_freedofs) )raw_string"))
       .value("AIJ"    , PETScMatrix::MAT_TYPE::AIJ)
       .value("BAIJ"   , PETScMatrix::MAT_TYPE::BAIJ)
       .value("IS_AIJ" , PETScMatrix::MAT_TYPE::IS_AIJ)
       .value("IS_BAIJ", PETScMatrix::MAT_TYPE::IS_BAIJ)
+      .value("SBAIJ"  , PETScMatrix::MAT_TYPE::SBAIJ)
       .export_values()
       ;
 
     pcm.def(py::init<>
 	    ([] (shared_ptr<ngs::BaseMatrix> mat, shared_ptr<ngs::BitArray> freedofs,
 		 shared_ptr<ngs::BitArray> row_freedofs, shared_ptr<ngs::BitArray> col_freedofs,
-		 py::object format)
+		 py::object format, bool spd, shared_ptr<ngs::FESpace> fes,
+		 bool bulk_csr, bool zero_copy, bool cached_update, bool coo, size_t mem_budget)
 	     {
+	       auto rss = freedofs ? freedofs : row_freedofs, css = freedofs ? freedofs : col_freedofs;
+	       ConversionOptions conv_opts;
+	       conv_opts.bulk_csr = bulk_csr;
+	       conv_opts.zero_copy = zero_copy;
+	       conv_opts.cached_update = cached_update;
+	       conv_opts.coo = coo;
+	       conv_opts.mem_budget = mem_budget;
+	       shared_ptr<NGs2PETScVecMap> row_map, col_map;
+	       if (fes != nullptr) {
+		 row_map = NGs2PETScVecMap::CreateInterleaved(fes, rss);
+		 col_map = (rss == css) ? row_map : NGs2PETScVecMap::CreateInterleaved(fes, css);
+	       }
+	       shared_ptr<PETScMatrix> pmat;
 	       if (format.is(py::none()))
-		 { return make_shared<PETScMatrix> (mat, freedofs ? freedofs : row_freedofs, freedofs ? freedofs : col_freedofs); }
+		 { pmat = make_shared<PETScMatrix> (mat, rss, css, row_map, col_map, conv_opts); }
 	       else
-		 { return make_shared<PETScMatrix> (mat, freedofs ? freedofs : row_freedofs, freedofs ? freedofs : col_freedofs,
-						    format.cast<PETScMatrix::MAT_TYPE>()); }
+		 { pmat = make_shared<PETScMatrix> (mat, rss, css, format.cast<PETScMatrix::MAT_TYPE>(), row_map, col_map, conv_opts); }
+	       if (spd)
+		 { pmat->SetSPD(true); }
+	       if (fes != nullptr)
+		 { pmat->SetVariableBlockSizes(fes); }
+	       return pmat;
 	     }), py::arg("ngs_mat"), py::arg("freedofs") = nullptr, py::arg("row_freedofs") = nullptr, py::arg("col_freedofs") = nullptr,
-	    py::arg("format") = py::none());
+	    py::arg("format") = py::none(), py::arg("spd") = false, py::arg("fes") = nullptr,
+	    py::arg("bulk_csr") = true, py::arg("zero_copy") = false, py::arg("cached_update") = true,
+	    py::arg("coo") = true, py::arg("mem_budget") = 0,
+	    docu_string(R"raw_string(
+fes: for VectorH1 (or compound spaces of the same scalar space), the components are interleaved
+     on PETSc-side, which gives a block matrix with block size dim. Vectors are converted
+     transparently. Other spaces are converted as usual.
+     In any case, the DOFs of the nodes of fes become variable blocks of the matrix (for "pc_type" : "vpbjacobi").
+     Only interleaved components end up in one block. Otherwise a block is one node of one component,
+     which for order 1 or 2 is a single DOF, so vpbjacobi is just jacobi (e.g. the VectorH1 in FESpace([V,Q])).
+
+How this matrix is converted:
+bulk_csr  .. build the CSR arrays at once (threaded) and hand them to PETSc in one call (default),
+             else insert block by block
+zero_copy .. sequential (or MATIS-local) AIJ matrices without freedofs share the index- and value
+             arrays with the NGSolve matrix. UpdateValues is then free, but anything PETSc does to
+             the matrix also changes the NGSolve matrix (default off).
+cached_update .. compute once where every PETSc value comes from, UpdateValues is then a (threaded)
+                 gather or a memcpy (default; not for MPIBAIJ)
+coo       .. parallel matrices that end up as MPIAIJ are assembled directly from global COO entries
+             (MatSetPreallocationCOO), not via MATIS and MatConvert (default).
+mem_budget .. if > 0, bytes the conversion may use for buffers, including its O(ndof) index arrays.
+              Rows are then converted in chunks, without building complete CSR- or COO arrays first
+              (default 0 = unlimited). Together
+              with cached_update=False and ReleaseNGsMatrix, this keeps the peak memory
+              close to the PETSc matrix itself.)raw_string"));
+
+    pcm.def_property_readonly("aliased", [](shared_ptr<PETScMatrix> & mat) { return mat->IsAliased(); },
+			      "PETSc works directly on the values of the NGSolve matrix");
+
+    pcm.def("ReleaseNGsMatrix", [](shared_ptr<PETScMatrix> & mat) { mat->ReleaseNGsMatrix(); },
+	    docu_string(R"raw_string(
+Drops the reference to the NGSolve matrix once PETSc has its values, only the vector maps are kept.
+The memory is freed as soon as nothing else (e.g. the BilinearForm) holds the NGSolve matrix.
+Afterwards, NGSolve-side products are computed by PETSc (with zeros outside of the freedofs), and
+UpdateValues is no longer possible.)raw_string"));
+
+    pcm.def_property_readonly("released", [](shared_ptr<PETScMatrix> & mat) { return mat->IsReleased(); },
+			      "The NGSolve matrix has been released, see ReleaseNGsMatrix");
+
+    pcm.def("SetVariableBlockSizes", [](shared_ptr<PETScMatrix> & mat, shared_ptr<ngs::FESpace> fes) { mat->SetVariableBlockSizes(fes); },
+	    py::arg("fes"), docu_string(R"raw_string(
+The DOFs of one node of one component of fes become one block of the matrix (MatSetVariableBlockSizes),
+which point-block smoothers like "pc_type" : "vpbjacobi" invert exactly. The components of a node are only
+in one block if the matrix was converted with interleaved components (fes given to the constructor), so this
+mostly helps for those and for high order nodes.)raw_string"));
+
+    pcm.def_property_readonly("n_filtered", [](shared_ptr<PETScMatrix> & mat) { return mat->GetNFiltered(); },
+			      "Number of duplicate C2C entries (on this rank) that were not put into the PETSc matrix");
 
     pcm.def("dump", [](shared_ptr<PETScMatrix> mat, string fn) {
 	cout << "dump mat to >>" << fn << "<<" << endl;
@@ -987,6 +3089,28 @@ IS_BAIJ .. sub-assembled diagonal blocks, blocks in sparse block matrix format (
 	      return make_shared<FlatPETScMatrix> (mat, freedofs ? freedofs : row_freedofs, freedofs ? freedofs : col_freedofs);
 	    }), py::arg("ngs_mat"), py::arg("freedofs") = nullptr, py::arg("row_freedofs") = nullptr, py::arg("col_freedofs") = nullptr);
 
+#ifndef PETSC_USE_COMPLEX
+    py::class_<FloatPETScMatrix, shared_ptr<FloatPETScMatrix>, FlatPETScMatrix>
+      (m, "FloatPETScMatrix", docu_string(R"raw_string(
+A shell matrix on a float copy of a sparse NGSolve-matrix, products are accumulated in double.
+It only provides products and the diagonal, so as Pmat it works with "pc_type" : "none" or "jacobi"
+(and Chebyshev/Jacobi smoothers), not with factorizations, ILU or AMG. Otherwise use it as operator
+of an inner KSP in an IterativeRefinement. Not available for complex PETSc.)raw_string"))
+      .def(py::init<>
+	   ([] (shared_ptr<ngs::BaseMatrix> mat, shared_ptr<ngs::BitArray> freedofs,
+		shared_ptr<ngs::BitArray> row_freedofs, shared_ptr<ngs::BitArray> col_freedofs )
+	    {
+	      return make_shared<FloatPETScMatrix> (mat, freedofs ? freedofs : row_freedofs, freedofs ? freedofs : col_freedofs);
+	    }), py::arg("ngs_mat"), py::arg("freedofs") = nullptr, py::arg("row_freedofs") = nullptr, py::arg("col_freedofs") = nullptr);
+#else
+    m.def("FloatPETScMatrix",
+	  ([] (shared_ptr<ngs::BaseMatrix> mat, shared_ptr<ngs::BitArray> freedofs,
+	       shared_ptr<ngs::BitArray> row_freedofs, shared_ptr<ngs::BitArray> col_freedofs )
+	   {
+	     throw Exception("FloatPETScMatrix is not available for complex PETSc");
+	   }), py::arg("ngs_mat"), py::arg("freedofs") = nullptr, py::arg("row_freedofs") = nullptr, py::arg("col_freedofs") = nullptr);
+#endif // PETSC_USE_COMPLEX
+
   }
 
 
@@ -7,7 +7,19 @@
 
 namespace ngs_petsc_interface
 {
-  /** 
+
+  /** Settings for converting an NGSolve-matrix to PETSc, given to the PETScMatrix constructors **/
+  struct ConversionOptions
+  {
+    bool bulk_csr = true;   // build the CSR arrays at once (threaded) and hand them to PETSc in one call, else insert block by block
+    bool zero_copy = false; // sequential/MATIS-local AIJ matrices without subsets use the index- and value arrays of the NGSolve matrix directly
+    bool cached_update = true; // PETScMatrix::UpdateValues uses a value-map computed once at conversion
+    bool coo = true;        // assemble MPIAIJ matrices directly from global COO entries instead of converting a MATIS
+    size_t mem_budget = 0;  // if > 0, bytes for conversion buffers (incl. index arrays): rows are converted chunk by chunk (no COO)
+  };
+
+
+  /**
       Can convert between NGSolve- and PETSc vectors
       If _build_maps == true, stores the DOF-mapping explicitely
   **/
@@ -27,20 +39,56 @@ namespace ngs_petsc_interface
     shared_ptr<ngs::BitArray> GetSubSet () const { return subset; }
 
     void NGs2PETSc (ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
-    void PETSc2NGs (ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
+    /**
+       stat == DISTRIBUTED: only master DOFs get values, others are set to zero
+       stat == CUMULATED: non-master DOFs get their values from the master
+    **/
+    void PETSc2NGs (ngs::BaseVector& ngs_vec, PETScVec petsc_vec, ngs::PARALLEL_STATUS stat = ngs::DISTRIBUTED);
+
+    /** Multiple vectors <-> columns of a dense PETSc-matrix (see CreatePETScDenseMatrix) **/
+    void NGs2PETSc (FlatArray<shared_ptr<ngs::BaseVector>> ngs_vecs, PETScMat petsc_dense);
+    void PETSc2NGs (FlatArray<shared_ptr<ngs::BaseVector>> ngs_vecs, PETScMat petsc_dense, ngs::PARALLEL_STATUS stat = ngs::DISTRIBUTED);
 
     void AddNGs2PETSc (double scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
     void AddNGs2PETSc (ngs::Complex scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
     void AddPETSc2NGs (double scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
     void AddPETSc2NGs (ngs::Complex scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
 
+    /** Not parallel and no subset: NGSolve- and PETSc-vectors have the same entries in the same order and can share memory **/
+    INLINE bool IsIdentity () const { return identity && (pardofs == nullptr); }
+    size_t GetNDof () const { return ndof; }
+
     size_t GetNRowsLocal  () const { return nrows_loc; }
     size_t GetNRowsGlobal () const { return nrows_glob; }
 
     FlatArray<PetscInt> GetDOFMap () const { return dof_map; }
     ISLocalToGlobalMapping GetISMap () const;
 
+    /**
+       Vector-valued spaces with bs equal scalar components (VectorH1, or compound spaces of the same space), interleaved:
+       PETSc row bs*k+l is component l of DOF k, which is entry l*ndof+k of the NGSolve-vector.
+       Then ndof, pardofs, subset and dof_map are those of the DOFs of one component ("nodes").
+       NGSolve-vectors keep the component-blocked layout of the space, the transfers permute.
+       An entry not in the subset of the space whose node is in the map is zero on PETSc-side.
+       Returns nullptr if the space can not be interleaved.
+    **/
+    static shared_ptr<NGs2PETScVecMap> CreateInterleaved (shared_ptr<ngs::FESpace> fes, shared_ptr<ngs::BitArray> subset);
+    INLINE bool IsInterleaved () const { return interleaved; }
+    /** (interleaved) the subset of the space, on NGSolve-entries **/
+    shared_ptr<ngs::BitArray> GetEntrySubSet () const { return entry_subset; }
+
+    /**
+       Variable block sizes of the local PETSc-rows (for MatSetVariableBlockSizes/PCVPBJACOBI):
+       the DOFs of one node of one component of fes are one block, for interleaved maps including all components.
+       PETSc-blocks must be consecutive rows, so different components of a node are different blocks.
+       Rows without a node are blocks of size 1. Returns false (and no block sizes) if fes does not fit to the map.
+       So the blocks only couple components for interleaved maps, otherwise they are bigger than 1 only for high order nodes.
+    **/
+    bool SetVariableBlockSizes (shared_ptr<ngs::FESpace> fes);
+    FlatArray<PetscInt> GetVariableBlockSizes () const { return var_bs; }
+
     PETScVec CreatePETScVector () const;
+    PETScMat CreatePETScDenseMatrix (int ncols) const;
     unique_ptr<ngs::BaseVector> CreateNGsVector () const;
 
   protected:
@@ -48,6 +96,22 @@ namespace ngs_petsc_interface
     template<class TSCAL> INLINE void AddNGs2PETSc_impl (TSCAL scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
     template<class TSCAL> INLINE void AddPETSc2NGs_impl (TSCAL scal, ngs::BaseVector& ngs_vec, PETScVec petsc_vec);
 
+    /** Local master-values, plus (for distributed vectors) the values of all other ranks, into a local PETSc-array **/
+    void GatherNGs2PETSc (ngs::BaseVector& ngs_vec, PETScScalar * pvs);
+    /** Local PETSc-array to ngs_vec, see PETSc2NGs **/
+    void ScatterPETSc2NGs (ngs::BaseVector& ngs_vec, const PETScScalar * pvs, ngs::PARALLEL_STATUS stat);
+
+    /** Calls f(ngs_first, petsc_first, len) for chunks of the runs, threaded and balanced by PETSc-rows **/
+    template<class FUNC> INLINE void ParallelIterateRuns (FUNC f) const;
+    /** Calls f(first, len) for all NGSolve-entries between the runs (that are not in the PETSc-vector) **/
+    template<class FUNC> INLINE void ParallelIterateGaps (FUNC f) const;
+
+    /** (interleaved) NGSolve-vector into perm_buf, entries not in entry_subset are zero **/
+    PETScScalar * Interleave (ngs::BaseVector & ngs_vec);
+    /** (interleaved) buf into NGSolve-vector; set: entries not in entry_subset are zero, add: they are left alone **/
+    void DeInterleave (const PETScScalar * buf, ngs::BaseVector & ngs_vec, bool add);
+    INLINE bool InEntrySubSet (size_t entry) const { return (entry_subset == nullptr) || entry_subset->Test(entry); }
+
 
     size_t ndof;
     int bs;
@@ -55,7 +119,16 @@ namespace ngs_petsc_interface
     shared_ptr<ngs::BitArray> subset;
     size_t nrows_loc, nrows_glob;
     Array<PetscInt> dof_map;         // maps ALL DOFS (not rows!) to global nums, non-subset get -1
-    ISLocalToGlobalMapping is_map;   // maps SUBSET DOFS (not rows!) to global nums (only constructed if parallel)
+    PETScHandle<ISLocalToGlobalMapping> is_map;   // maps SUBSET DOFS (not rows!) to global nums (only constructed if parallel)
+    PETScHandle<PETScSF> sf;                      // leaves: entries of non-master SUBSET DOFS, roots: their rows on the master (only if parallel)
+    bool identity;                   // all entries are in the PETSc-vector, in the same order
+    Array<size_t> run_first;         // runs of consecutive DOFs that are in the PETSc-vector: first NGSolve entry (not DOF!)
+    Array<size_t> run_offset;        // ... and first PETSc-row of each run (one more entry than runs, the last is nrows_loc)
+    bool interleaved = false;        // see CreateInterleaved
+    shared_ptr<ngs::BitArray> entry_subset;       // (interleaved) subset of the space, on NGSolve-entries
+    shared_ptr<ngs::ParallelDofs> entry_pardofs;  // (interleaved) pardofs of the space, for NGSolve-vectors
+    Array<PETScScalar> perm_buf;                  // (interleaved) NGSolve-vector in PETSc-order
+    Array<PetscInt> var_bs;                       // block sizes of the local rows, see SetVariableBlockSizes
   };
 
   /** Ports an NGSolve-BaseMatrix to PETSc **/
@@ -68,8 +141,6 @@ namespace ngs_petsc_interface
       : row_map(_row_map), col_map(_col_map), ngs_mat(_ngs_mat), row_subset(_row_subset), col_subset(_col_subset)
     { ; }
 
-    ~PETScBaseMatrix () { /* MatDestroy(&petsc_mat); */ }
-
     /** Call this if the NGSolve-Matrix has changed and you want to get the new values to PETSc **/
     virtual void UpdateValues () { ; }
 
@@ -104,7 +175,7 @@ namespace ngs_petsc_interface
     shared_ptr<NGs2PETScVecMap> row_map, col_map;
     shared_ptr<ngs::BaseMatrix> ngs_mat;
     shared_ptr<ngs::BitArray> row_subset, col_subset;
-    PETScMat petsc_mat;
+    PETScHandle<PETScMat> petsc_mat;
   };
 
 
@@ -120,19 +191,74 @@ namespace ngs_petsc_interface
     enum MAT_TYPE : uint8_t { AIJ = 0,      // Sparse Matrix (either MATSEQAIJ or MATMPIAIJ)
 			      BAIJ = 1,     // Sparse Block-Matrix (either MATSEQAIJ or MATMPIBAIJ)
 			      IS_AIJ = 2,   // Sub-Assembled diagonal blocks, local mats in sparse format
-			      IS_BAIJ = 3}; // Sub-Assembled diagonal blocks, local mats in sparse block-format
+			      IS_BAIJ = 3,  // Sub-Assembled diagonal blocks, local mats in sparse block-format
+			      SBAIJ = 4 };  // Symmetric Sparse Block-Matrix, upper triangle only (either MATSEQSBAIJ or MATMPISBAIJ)
     PETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
 		 shared_ptr<ngs::BitArray> _col_subset, shared_ptr<NGs2PETScVecMap> _row_map = nullptr,
-		 shared_ptr<NGs2PETScVecMap> _col_map = nullptr);
+		 shared_ptr<NGs2PETScVecMap> _col_map = nullptr, const ConversionOptions & _conv_opts = ConversionOptions());
 
     PETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
 		 shared_ptr<ngs::BitArray> _col_subset, MAT_TYPE _petsc_mat_type,
-		 shared_ptr<NGs2PETScVecMap> _row_map = nullptr, shared_ptr<NGs2PETScVecMap> _col_map = nullptr);
+		 shared_ptr<NGs2PETScVecMap> _row_map = nullptr, shared_ptr<NGs2PETScVecMap> _col_map = nullptr,
+		 const ConversionOptions & _conv_opts = ConversionOptions());
+
+    const ConversionOptions & GetConversionOptions () const { return conv_opts; }
 
     virtual void UpdateValues ();
 
+    /** PETSc works directly on the values of the NGSolve matrix (see ConversionOptions::zero_copy) **/
+    bool IsAliased () const { return aliased; }
+
+    /** Number of duplicate entries of a C2C matrix that were left out of the PETSc matrix on this rank **/
+    size_t GetNFiltered () const { return n_filtered; }
+
+    /** Tell PETSc the matrix is symmetric positive definite (symmetric NGSolve matrices are always flagged symmetric) **/
+    void SetSPD (bool spd = true);
+
+    /** Drop the reference to the NGSolve matrix, NGSolve-side products are then computed by PETSc.
+	Values can not be updated anymore. **/
+    void ReleaseNGsMatrix ();
+    bool IsReleased () const { return released; }
+
+    /** Node-blocks of fes as variable block sizes of the PETSc matrix (square matrices only, see NGs2PETScVecMap) **/
+    void SetVariableBlockSizes (shared_ptr<ngs::FESpace> fes);
+
+    /** Where the values of the (local) PETSc matrix come from in the NGSolve matrix **/
+    struct UpdatePlan
+    {
+      bool valid = false;
+      bool identity = false;         // values are in the same order, a memcpy does the job
+      bool coo = false;              // values are pushed with MatSetValuesCOO, src is in COO order
+      bool set_blocked = false;      // SEQBAIJ/SEQSBAIJ, values are set one block row at a time
+      int bs = 1;
+      Array<size_t> src;             // for every PETSc value the position in the NGSolve values, size_t(-1) -> zero
+      Array<PETScInt> rowptr, cols;  // block-CSR graph (only set_blocked)
+      Array<PETScScalar> buffer;     // values in block-CSR/COO order (only set_blocked or coo)
+    };
+
   protected:
-    void ConvertMat (); // For a parallel matrix, converts to MATIS, else to SEQAIJ or SEQBAIJ
+    void ConvertMat (bool sbaij = false); // For a parallel matrix, converts to MATIS, else to SEQAIJ or SEQBAIJ (or SEQSBAIJ)
+    bool ConvertMatCOO (bool allow_blocks); // Parallel matrix directly to MPIAIJ, returns false if not possible
+    void FinishConversion (); // call after converting petsc_mat to it's final format
+    void CheckAlias ();
+    void BuildUpdatePlan ();
+    void CreateInterleavedMatrix (); // SEQBAIJ (or MATIS) on the nodes of a scalar matrix, for interleaved maps
+    PETScMat CreateInterleavedLocalMat () const;
+    void SetInterleavedValues (PETScMat loc_mat) const;
+    void UpdateInterleavedValues ();
+    void ApplyVariableBlockSizes (); // block sizes of col_map (the rows) -> petsc_mat
+
+    ConversionOptions conv_opts;
+    bool interleaved = false;
+    Array<PETScInt> conv_rowptr, conv_cols; // (interleaved) block-CSR graph of the local SEQBAIJ, on compressed nodes
+    PETScInt conv_ncols = 0;                // (interleaved) number of block columns of the local SEQBAIJ
+    Array<size_t> conv_src;                 // (interleaved) for every SEQBAIJ value the NGSolve value, -1 -> 0, -2 -> 1
+    bool conv_symmetric = false;
+    bool aliased = false;
+    Array<PETScInt> alias_rowptr; // NGSolve row pointers are size_t, so we need a copy of these
+    UpdatePlan plan;
+    size_t n_filtered = 0;
+    bool released = false;
   };
 
 
@@ -152,12 +278,92 @@ namespace ngs_petsc_interface
 
   protected:
     static PetscErrorCode MatMult (PETScMat A, PETScVec x, PETScVec y);
+    static PetscErrorCode MatMatMult (PETScMat A, PETScMat B, PETScMat C, void * data);
+    /** Y = ngs_mat * X for dense X and Y, all columns in one MultiMultAdd **/
+    void MultDense (PETScMat X, PETScMat Y);
     shared_ptr<ngs::BaseVector> row_hvec, col_hvec;
+    Array<shared_ptr<ngs::BaseVector>> row_hvecs, col_hvecs; // for MultDense
   };
 
 
+#ifndef PETSC_USE_COMPLEX // the float copies are real only
+  /**
+     Local sparse matrix with float values, products are accumulated in PETScScalar.
+     Symmetric NGSolve matrices are stored in full.
+  **/
+  class FloatSparseMatrix : public ngs::BaseMatrix
+  {
+  public:
+    FloatSparseMatrix (shared_ptr<ngs::BaseMatrix> spmat);
+
+    virtual int VHeight () const override { return h; }
+    virtual int VWidth () const override { return w; }
+    virtual ngs::AutoVector CreateRowVector () const override;
+    virtual ngs::AutoVector CreateColVector () const override;
+
+    virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override
+    { y = 0.0; MultAdd(1.0, x, y); }
+    virtual void MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const override;
+
+    /** diagonal entries of the diagonal blocks, bs values per row **/
+    void GetDiagonal (PETScScalar * diag) const;
+
+    int GetBS () const { return bs; }
+
+  protected:
+    int bs = 1;
+    size_t h = 0, w = 0;
+    Array<PETScInt> rowptr, cols; // block-CSR
+    Array<float> vals;            // bs x bs blocks, row-major
+  };
+
+
+  /**
+     Shell matrix on a float copy of a (parallel) sparse matrix, MatMult moves about half the data.
+     Can be used as Pmat only for PCs that need nothing but products and the diagonal (none, jacobi, chebyshev/jacobi smoothers),
+     or as operator of an inner KSP in an iterative refinement (see PETScIterativeRefinement).
+  **/
+  class FloatPETScMatrix : public FlatPETScMatrix
+  {
+  public:
+    FloatPETScMatrix (shared_ptr<ngs::BaseMatrix> _ngs_mat, shared_ptr<ngs::BitArray> _row_subset,
+		      shared_ptr<ngs::BitArray> _col_subset, shared_ptr<NGs2PETScVecMap> _row_map = nullptr,
+		      shared_ptr<NGs2PETScVecMap> _col_map = nullptr);
+
+  protected:
+    static shared_ptr<ngs::BaseMatrix> CreateFloatMatrix (shared_ptr<ngs::BaseMatrix> mat);
+    static PetscErrorCode GetDiagonal (PETScMat A, PETScVec d);
+    shared_ptr<FloatSparseMatrix> float_mat;
+    ngs::PARALLEL_STATUS diag_status; // local diagonals of C2D matrices have to be added up
+  };
+#endif // PETSC_USE_COMPLEX
+
+
   MatNullSpace NullSpaceCreate (FlatArray<shared_ptr<ngs::BaseVector>> vecs, shared_ptr<NGs2PETScVecMap> map,
 				bool is_orthonormal = false, bool const_kernel = false);
+
+  /**
+     Node coordinates of H1 spaces (also with dim > 1), VectorH1 and compounds of scalar H1 spaces:
+     xyz are cumulated vectors of fes, every DOF gets the vertex or the center of the edge/face/cell it belongs to,
+     entry_comp (if given) the component of every entry. With vertices_only, only vertex-DOFs are set
+     (enough for linear functions in the hierarchical basis), others stay 0 / -1.
+     Returns the number of components, 0 for other spaces.
+  **/
+  int H1NodeCoordinates (shared_ptr<ngs::FESpace> fes, bool vertices_only,
+			 Array<shared_ptr<ngs::BaseVector>> & xyz, Array<int> * entry_comp = nullptr);
+
+  /** constant/rigid body modes of an H1/VectorH1 space, nullptr for other spaces
+      (with vector_only also for spaces that do not have one component per space dimension) **/
+  MatNullSpace RigidBodyNullSpaceCreate (shared_ptr<ngs::FESpace> fes, shared_ptr<NGs2PETScVecMap> map, bool vector_only = false);
+
+  /**
+     Coordinates for the local PETSc rows of an H1/VectorH1 space (for PCSetCoordinates), dim values per row.
+     Vertex-DOFs get the vertex, higher order DOFs the center of their edge/face/cell. Those are not points of
+     the basis functions, with vertices_only there are no coordinates (returns 0) unless all rows are vertex-DOFs.
+     Returns the dimension, or 0 for other spaces.
+  **/
+  int RowCoordinatesCreate (shared_ptr<ngs::FESpace> fes, shared_ptr<NGs2PETScVecMap> map, Array<PetscReal> & coords,
+			    bool vertices_only = false);
   
 } // namespace ngs_petsc_interface
 
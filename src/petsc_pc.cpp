@@ -9,7 +9,7 @@ namespace ngs_petsc_interface
 
   PETScBasePrecond :: PETScBasePrecond (MPI_Comm comm, string _name, FlatArray<string> _petsc_options)
   {
-    PCCreate(comm, &petsc_pc);
+    PCCreate(comm, &petsc_pc.Get());
 
     name = (_name.size()) ? name : GetDefaultId();
     PCSetOptionsPrefix(petsc_pc, name.c_str());
@@ -31,7 +31,7 @@ namespace ngs_petsc_interface
 
     MPI_Comm comm = (pardofs != nullptr) ? MPI_Comm(pardofs->GetCommunicator()) : PETSC_COMM_SELF;
 
-    PCCreate(comm, &petsc_pc);
+    PCCreate(comm, &petsc_pc.Get());
 
     name = (_name.size()) ? name : GetDefaultId();
     PCSetOptionsPrefix(petsc_pc, name.c_str());
@@ -60,13 +60,24 @@ namespace ngs_petsc_interface
 
   PETSc2NGsPrecond :: PETSc2NGsPrecond (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags, const string _aname)
     : PETScBasePrecond(_bfa->GetFESpace()->IsParallel() ? MPI_Comm(_bfa->GetFESpace()->GetParallelDofs()->GetCommunicator()) : PETSC_COMM_SELF, _aname),
-      ngs::Preconditioner (_bfa, _aflags, _aname), bfa(_bfa)
+      ngs::Preconditioner (_bfa, _aflags, _aname), bfa(_bfa), fes(_bfa->GetFESpace())
   {
     auto & petsc_options = flags.GetStringListFlag("petsc_pc_petsc_options");
     SetOptions(petsc_options, PETScBasePrecond::GetName(), NULL);
   }
 
 
+  PETSc2NGsPrecond :: PETSc2NGsPrecond (shared_ptr<PETScBaseMatrix> _petsc_amat, shared_ptr<PETScBaseMatrix> _petsc_pmat,
+					string _name, FlatArray<string> _petsc_options, shared_ptr<ngs::FESpace> _fes, bool _finalize)
+    : PETScBasePrecond(_petsc_amat, _petsc_pmat, _name, _petsc_options),
+      ngs::Preconditioner( shared_ptr<ngs::BilinearForm>(), ngs::Flags({"not_register_for_auto_update"}), _name),
+      fes(_fes)
+  {
+    if (_finalize)
+      { Finalize(); }
+  }
+
+
   PETSc2NGsPrecond :: PETSc2NGsPrecond (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname)
     : PETScBasePrecond(MPI_COMM_NULL, ""), ngs::Preconditioner( &_apde, _aflags, _aname)
   { throw Exception("Not implemented! (Who still uses PDE files?)"); }
@@ -94,14 +105,83 @@ namespace ngs_petsc_interface
     Finalize();
   }
 
+
+  void PETSc2NGsPrecond :: Finalize ()
+  {
+    if (petsc_amat != nullptr)
+      { PCSetOperators(GetPETScPC(), petsc_amat->GetPETScMat(), (petsc_pmat != nullptr) ? petsc_pmat->GetPETScMat() : petsc_amat->GetPETScMat()); }
+
+    PCSetFromOptions(GetPETScPC());
+
+    // coordinates need the type and the operators (GAMG takes the layout from the pmat), near-nullspace has to come before PCSetUp
+    SetUpFromFESpace();
+
+    PCSetUp(GetPETScPC());
+  } // PETSc2NGsPrecond::Finalize
+
+
+  void PETSc2NGsPrecond :: SetUpFromFESpace ()
+  {
+    if (fes == nullptr)
+      { return; }
+
+    auto pmat = (petsc_pmat != nullptr) ? petsc_pmat : petsc_amat;
+    if (pmat == nullptr)
+      { return; }
+
+    // node-blocks for vpbjacobi, can be turned off with petsc_pc_variable_blocks=False
+    if (!flags.GetDefineFlagX("petsc_pc_variable_blocks").IsFalse())
+      if (auto petsc_mat = dynamic_pointer_cast<PETScMatrix>(pmat))
+	{ petsc_mat->SetVariableBlockSizes(fes); }
+
+    // rigid body modes for elasticity (GAMG needs them): by default only for vector-valued spaces with one component
+    // per space dimension, petsc_pc_near_nullspace=True also gives the constants of scalar H1, False turns them off
+    auto ns_flag = flags.GetDefineFlagX("petsc_pc_near_nullspace");
+    if (!ns_flag.IsFalse()) {
+      if (auto ns = RigidBodyNullSpaceCreate(fes, pmat->GetRowMap(), !ns_flag.IsTrue())) {
+	pmat->SetNearNullSpace(ns);
+	MatNullSpaceDestroy(&ns);
+      }
+    }
+
+    // coordinates for GAMG/BoomerAMG/...: by default only if all rows are vertex-DOFs (i.e. order 1), PCSetCoordinates
+    // wants one point per row and higher order DOFs only have the center of their edge/face/cell.
+    // petsc_pc_coordinates=True uses those centers anyway, False turns coordinates off.
+    // (not for MATIS, BDDC would want them in the subdomain numbering)
+    PetscBool is_matis; PetscObjectTypeCompare((PetscObject)pmat->GetPETScMat(), MATIS, &is_matis);
+    auto coord_flag = flags.GetDefineFlagX("petsc_pc_coordinates");
+    if ( (!is_matis) && (!coord_flag.IsFalse()) ) {
+      Array<PetscReal> coords;
+      if (int cdim = RowCoordinatesCreate(fes, pmat->GetRowMap(), coords, !coord_flag.IsTrue())) {
+	PetscInt mbs; MatGetBlockSize(pmat->GetPETScMat(), &mbs);
+	size_t nloc = coords.Size() / (cdim * mbs);
+	Array<PetscReal> node_coords(cdim * nloc);
+	for (auto k : Range(nloc))
+	  for (auto j : Range(cdim))
+	    { node_coords[cdim * k + j] = coords[cdim * mbs * k + j]; }
+	PCSetCoordinates(GetPETScPC(), cdim, nloc, node_coords.Data());
+      }
+    }
+  } // PETSc2NGsPrecond::SetUpFromFESpace
+
+
   void PETSc2NGsPrecond :: MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const
   {
     static ngs::Timer t("PETSc2NGsPrecond::MultAdd"); ngs::RegionTimer rt(t);
 
-    GetAMat()->GetRowMap()->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs);
+    auto row_map = GetAMat()->GetRowMap();
+    bool alias_rhs = row_map->IsIdentity();
+
+    if (alias_rhs)
+      { VecPlaceArray(petsc_rhs, x.FV<PETScScalar>().Data()); }
+    else
+      { row_map->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs); }
 
     PCApply (GetPETScPC(), petsc_rhs, petsc_sol);
 
+    if (alias_rhs)
+      { VecResetArray(petsc_rhs); }
+
     GetAMat()->GetColMap()->AddPETSc2NGs(scal, y, petsc_sol);
 
   }
@@ -110,11 +190,25 @@ namespace ngs_petsc_interface
   {
     static ngs::Timer t("PETSc2NGsPrecond::Mult"); ngs::RegionTimer rt(t);
 
-    GetAMat()->GetRowMap()->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs);
+    auto row_map = GetAMat()->GetRowMap(), col_map = GetAMat()->GetColMap();
+    bool alias_rhs = row_map->IsIdentity();
+    bool alias_sol = col_map->IsIdentity() && (x.FV<PETScScalar>().Data() != y.FV<PETScScalar>().Data());
+
+    if (alias_rhs)
+      { VecPlaceArray(petsc_rhs, x.FV<PETScScalar>().Data()); }
+    else
+      { row_map->NGs2PETSc(const_cast<ngs::BaseVector&>(x), petsc_rhs); }
+    if (alias_sol)
+      { VecPlaceArray(petsc_sol, y.FV<PETScScalar>().Data()); }
 
     PCApply (GetPETScPC(), petsc_rhs, petsc_sol);
 
-    GetAMat()->GetColMap()->PETSc2NGs(y, petsc_sol);
+    if (alias_rhs)
+      { VecResetArray(petsc_rhs); }
+    if (alias_sol)
+      { VecResetArray(petsc_sol); }
+    else
+      { col_map->PETSc2NGs(y, petsc_sol); }
 
   }
 
@@ -147,6 +241,8 @@ namespace ngs_petsc_interface
 
     PCShellSetApply(GetPETScPC(), this->ApplyPC);
 
+    PCShellSetMatApply(GetPETScPC(), this->MatApplyPC);
+
     if (_finalize)
       { Finalize(); }
   }
@@ -158,11 +254,37 @@ namespace ngs_petsc_interface
     void* ptr; PCShellGetContext(pc, &ptr);
     auto & n2p_pre = *( (NGs2PETScPrecond*) ptr);
 
-    n2p_pre.GetAMat()->GetRowMap()->PETSc2NGs(*n2p_pre.row_hvec, x);
+    auto row_map = n2p_pre.GetAMat()->GetRowMap(), col_map = n2p_pre.GetAMat()->GetColMap();
+    if (row_map->IsIdentity() && col_map->IsIdentity()) {
+      // work directly on the PETSc arrays
+      const PETScScalar * xs; VecGetArrayRead(x, &xs);
+      PETScScalar * ys; VecGetArray(y, &ys);
+      ngs::S_BaseVectorPtr<PETScScalar> xv(row_map->GetNDof(), row_map->GetBS(), const_cast<PETScScalar*>(xs));
+      ngs::S_BaseVectorPtr<PETScScalar> yv(col_map->GetNDof(), col_map->GetBS(), ys);
+      n2p_pre.GetNGsMat()->Mult(xv, yv);
+      VecRestoreArray(y, &ys);
+      VecRestoreArrayRead(x, &xs);
+      return PetscErrorCode(0);
+    }
+
+    row_map->PETSc2NGs(*n2p_pre.row_hvec, x);
 
     n2p_pre.GetNGsMat()->Mult(*n2p_pre.row_hvec, *n2p_pre.col_hvec);
 
-    n2p_pre.GetAMat()->GetColMap()->NGs2PETSc(*n2p_pre.col_hvec, y);
+    col_map->NGs2PETSc(*n2p_pre.col_hvec, y);
+
+    return PetscErrorCode(0);
+  }
+
+
+  PetscErrorCode NGs2PETScPrecond :: MatApplyPC (PETScPC pc, PETScMat X, PETScMat Y)
+  {
+    static ngs::Timer t("NGs2PETScPrecond::MatApplyPC"); ngs::RegionTimer rt(t);
+
+    void* ptr; PCShellGetContext(pc, &ptr);
+    auto & n2p_pre = *( (NGs2PETScPrecond*) ptr);
+
+    n2p_pre.MultDense(X, Y);
 
     return PetscErrorCode(0);
   }
@@ -204,8 +326,8 @@ namespace ngs_petsc_interface
   }
 
   PETScHypreAuxiliarySpacePC :: PETScHypreAuxiliarySpacePC (shared_ptr<PETScBaseMatrix> _petsc_amat, shared_ptr<PETScBaseMatrix> _petsc_pmat,
-							    string _name, FlatArray<string> _petsc_options)
-    : PETSc2NGsPrecond(_petsc_amat, _petsc_pmat, _name, _petsc_options)
+							    string _name, FlatArray<string> _petsc_options, bool _finalize)
+    : PETSc2NGsPrecond(_petsc_amat, _petsc_pmat, _name, _petsc_options, nullptr, _finalize)
   {
     ;
   }
@@ -219,6 +341,29 @@ namespace ngs_petsc_interface
   }
 
 
+  bool PETScHypreAuxiliarySpacePC :: AuxDataValid (shared_ptr<ngs::MeshAccess> ma, shared_ptr<ngs::BitArray> freedofs) const
+  {
+    if ( (!own_aux) || (ma->GetTimeStamp() != aux_timestamp) )
+      { return false; }
+    if ( (freedofs == nullptr) || (aux_freedofs == nullptr) )
+      { return (freedofs == nullptr) && (aux_freedofs == nullptr); }
+    if (freedofs->Size() != aux_freedofs->Size())
+      { return false; }
+    for (auto k : Range(freedofs->Size()))
+      if (freedofs->Test(k) != aux_freedofs->Test(k))
+	{ return false; }
+    return true;
+  }
+
+
+  void PETScHypreAuxiliarySpacePC :: SetAuxDataBuilt (shared_ptr<ngs::MeshAccess> ma, shared_ptr<ngs::BitArray> freedofs)
+  {
+    own_aux = true;
+    aux_timestamp = ma->GetTimeStamp();
+    aux_freedofs = (freedofs == nullptr) ? nullptr : make_shared<BitArray>(*freedofs);
+  }
+
+
   void PETScHypreAuxiliarySpacePC :: FinalizeLevel (const ngs::BaseMatrix * mat)
   {
     // PC, dim (used for AMS), HD-embed, HD-embed components, HC-embed, HC-embed components
@@ -227,10 +372,71 @@ namespace ngs_petsc_interface
 			       HD_embed ? HD_embed->GetPETScMat() : NULL, NULL,
 			       HC_embed ? HC_embed->GetPETScMat() : NULL, NULL);
     }
+    else if ( coords.Size() && (grad_mat != nullptr) ) { // hypre builds the interpolations from the coordinates
+      auto h1_map = grad_mat->GetRowMap();
+      size_t nloc = h1_map->GetNRowsLocal(), cdim = coords.Size();
+      Array<PetscReal> xyz(cdim * nloc);
+      PETScVec pvec = h1_map->CreatePETScVector();
+      for (auto j : Range(cdim)) {
+	h1_map->NGs2PETSc(*coords[j], pvec);
+	const PETScScalar * vals; VecGetArrayRead(pvec, &vals);
+	for (auto k : Range(nloc))
+	  { xyz[cdim * k + j] = PetscRealPart(vals[k]); }
+	VecRestoreArrayRead(pvec, &vals);
+      }
+      VecDestroy(&pvec);
+      PCSetCoordinates(GetPETScPC(), cdim, nloc, xyz.Data());
+    }
     PETSc2NGsPrecond :: FinalizeLevel();
   }
 
 
+  /**
+     x/y(/z) in the basis of a scalar (hierarchical) H1 space: the vertex coordinates on the vertex-DOFs, zero elsewhere.
+     This is exact for linear functions, and much cheaper than SetValues on curved/high order meshes.
+     Returns an empty array for other spaces.
+  **/
+  static Array<shared_ptr<ngs::BaseVector>> VertexCoordinates (shared_ptr<ngs::FESpace> fesh1)
+  {
+    Array<shared_ptr<ngs::BaseVector>> xyz;
+    if ( (fesh1->GetDimension() != 1) || (H1NodeCoordinates(fesh1, true, xyz) == 0) )
+      { xyz.SetSize(0); }
+    return xyz;
+  } // VertexCoordinates
+
+
+  /**
+     DOFs of an auxiliary space (domain of emb) that are connected to a DOF in range_subset.
+     Has to be consistent, e.g. a vertex on an interface with only one free edge, which is in the interior of one of the procs.
+  **/
+  static shared_ptr<ngs::BitArray> AuxiliarySubSet (shared_ptr<ngs::BaseMatrix> emb, shared_ptr<ngs::BitArray> range_subset,
+						    shared_ptr<ngs::FESpace> aux_fes)
+  {
+    if (range_subset == nullptr)
+      { return nullptr; }
+    auto aux_subset = make_shared<BitArray>(aux_fes->GetNDof());
+    aux_subset->Clear();
+    auto spmat = dynamic_pointer_cast<ngs::BaseSparseMatrix>(emb);
+    for (auto k : Range(spmat->Height())) {
+      if (range_subset->Test(k)) {
+	for (auto j : spmat->GetRowIndices(k))
+	  { aux_subset->SetBit(j); }
+      }
+    }
+    if (aux_fes->IsParallel()) {
+      auto vec = make_shared<ngs::S_ParallelBaseVectorPtr<double>>(aux_fes->GetNDof(), 1, aux_fes->GetParallelDofs(), ngs::DISTRIBUTED);
+      auto fv = vec->FVDouble();
+      for (auto k : Range(fv))
+	{ fv[k] = aux_subset->Test(k) ? 1 : 0; }
+      vec->Cumulate();
+      for (auto k : Range(fv))
+	if (fv[k] != 0)
+	  { aux_subset->SetBit(k); }
+    }
+    return aux_subset;
+  } // AuxiliarySubSet
+
+
   PETScHypreAMS :: PETScHypreAMS (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags, const string _aname)
     : PETScHypreAuxiliarySpacePC (_bfa, _aflags, _aname)
   {
@@ -265,12 +471,22 @@ namespace ngs_petsc_interface
 
   void PETScHypreAMS :: InitLevel (shared_ptr<ngs::BitArray> freedofs)
   {
+    static ngs::Timer t("PETScHypreAMS::InitLevel"); ngs::RegionTimer rt(t);
 
     PETSc2NGsPrecond :: InitLevel (freedofs);
 
     if ( bfa == nullptr )
       { throw Exception("PETScHypreAMS::InitLevel called, but we have no bilinearform. How did we get here??"); }
 
+    auto ma = bfa->GetMeshAccess();
+
+    if ( own_aux && !AuxDataValid(ma, subset) ) { // mesh or free DOFs changed, drop what we built
+      grad_mat = nullptr;
+      ozz = zoz = zzo = nullptr;
+      coords.SetSize0();
+      own_aux = false;
+    }
+
     if (grad_mat == nullptr) { // we have no discrete gradient matrix
       // try to construct it here
 
@@ -279,35 +495,17 @@ namespace ngs_petsc_interface
       shared_ptr<ngs::BaseMatrix> grad = feshc->CreateGradient(*fesh1);
 
       shared_ptr<ngs::BitArray> h1_subset;
-
-      if (freedofs != bfa->GetFESpace()->GetFreeDofs()) { // we are being used as a coarse grid solver I think
-	// adjust freedofs for the scalar h1-space
-	h1_subset = make_shared<BitArray>(fesh1->GetNDof());
-	h1_subset->Clear();
-	auto spmat = dynamic_pointer_cast<ngs::BaseSparseMatrix>(grad);
-	for (auto k : Range(spmat->Height())) {
-	  if (subset->Test(k)) {
-	    for (auto j : spmat->GetRowIndices(k))
-	      { h1_subset->SetBit(j); }
-	  }
-	}
-	if (fesh1->IsParallel()) {
-	  // say there is a vertex on an an interface with only one free edge, which is in the interior of one of the procs
-	  // -> we have to make this consistent!
-	  auto vec = make_shared<ngs::S_ParallelBaseVectorPtr<double>>(fesh1->GetNDof(), 1, fesh1->GetParallelDofs(), ngs::DISTRIBUTED);
-	  auto fv = vec->FVDouble();
-	  for (auto k : Range(fv))
-	    { fv[k] = h1_subset->Test(k) ? 1 : 0; }
-	  vec->Cumulate();
-	  size_t add = 0;
-	  for (auto k : Range(fv))
-	    { if (fv[k] != 0) { if (!h1_subset->Test(k)) add++; h1_subset->SetBit(k); } }
-	}
-      }
+      if (freedofs != bfa->GetFESpace()->GetFreeDofs()) // we are being used as a coarse grid solver I think
+	{ h1_subset = AuxiliarySubSet(grad, subset, fesh1); }
       else
 	{ h1_subset = fesh1->GetFreeDofs(); }
       
-      if ( (HC_embed == nullptr) && (ozz == nullptr) ) { // we have no H1-to-HCurl embedding and no constant vecs
+      if ( (HC_embed == nullptr) && (ozz == nullptr) && (coords.Size() == 0) ) { // we have no H1-to-HCurl embedding, constant vecs or coordinates
+	// hypre computes the constant vectors as G * (x,y,z)
+	SetVertexCoordinates(VertexCoordinates(fesh1));
+      }
+
+      if ( (HC_embed == nullptr) && (ozz == nullptr) && (coords.Size() == 0) ) {
 	// construct (1,0,0), (0,1,0), (0,0,1) in HCurl basis
 	ngs::Flags flags;
 	flags.SetFlag("novisual");
@@ -341,9 +539,7 @@ namespace ngs_petsc_interface
 
       grad_mat = make_shared<PETScMatrix> (grad, h1_subset, subset);
 
-      // PetscViewer ov; PetscViewerASCIIOpen(MPI_COMM_WORLD,"gmat2.mat",&ov);
-      // MatView(grad_mat->GetPETScMat(), ov);
-
+      SetAuxDataBuilt(ma, subset);
     }
     
   }
@@ -351,15 +547,17 @@ namespace ngs_petsc_interface
 
   void PETScHypreAMS :: FinalizeLevel (const ngs::BaseMatrix * mat)
   {
-    if (petsc_amat == nullptr) { // probably build via RegisterPreconditioner - convert matrix
+    // re-use vec-map if possible
+    shared_ptr<NGs2PETScVecMap> vec_map = (grad_mat != nullptr) ? grad_mat->GetColMap() : nullptr;
+    if ( (petsc_amat == nullptr) || // probably build via RegisterPreconditioner - convert matrix
+	 ( (mat != nullptr) && ( (petsc_amat->GetNGsMat().get() != mat) || (petsc_amat->GetRowMap() != vec_map) ) ) ) { // new level
       if (mat == nullptr)
 	{ throw Exception("PETScHypreAMS::FinalizeLevel, have no matrix!"); }
-      shared_ptr<NGs2PETScVecMap> vec_map;
-      if (grad_mat != nullptr) // re-use vec-map if possible
-	{ vec_map = grad_mat->GetColMap(); }
       petsc_pmat = petsc_amat = make_shared<PETScMatrix> (shared_ptr<BaseMatrix>(const_cast<BaseMatrix*>(mat), NOOP_Deleter),
 							  subset, subset, vec_map, vec_map);
     }
+    else if (mat != nullptr) // same matrix, maybe re-assembled
+      { petsc_amat->UpdateValues(); }
 
     if (grad_mat == nullptr) {
       // should we try to construct this from bfa->GetFESpace? This sould have happened in InitLevel already ...
@@ -376,12 +574,343 @@ namespace ngs_petsc_interface
       if (zzo != nullptr)
 	{ hc_map->NGs2PETSc(*zzo, pzzo); }
       PCHYPRESetEdgeConstantVectors(GetPETScPC(), pozz, pzoz, (zzo != nullptr) ? pzzo : NULL);
+      VecDestroy(&pozz); VecDestroy(&pzoz); VecDestroy(&pzzo);
+    }
+
+    // with the auxiliary Poisson matrices, AMS does not have to compute the Galerkin products itself
+    if (alpha_mat != nullptr)
+      { PCHYPRESetAlphaPoissonMatrix(GetPETScPC(), alpha_mat->GetPETScMat()); }
+    if (beta_mat != nullptr)
+      { PCHYPRESetBetaPoissonMatrix(GetPETScPC(), beta_mat->GetPETScMat()); }
+
+    PETScHypreAuxiliarySpacePC :: FinalizeLevel (mat);
+  }
+
+
+  PETScHypreADS :: PETScHypreADS (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags, const string _aname)
+    : PETScHypreAuxiliarySpacePC (_bfa, _aflags, _aname)
+  {
+    if (bfa == nullptr)
+      { throw Exception("ADS Preconditioner with nullptr BLF, not sure how that happens..."); }
+
+    if (dynamic_pointer_cast<ngs::HDivHighOrderFESpace>(bfa->GetFESpace()) == nullptr)
+      { throw Exception(string("ADS does not work for space") + typeid(_bfa->GetFESpace()).name() + string("!!")); }
+
+    if (bfa->GetMeshAccess()->GetDimension() != 3)
+      { throw Exception("ADS only works in 3d!"); }
+
+    // the discrete curl maps to the lowest order DOFs only, higher order ones would get no correction at all
+    if (bfa->GetFESpace()->GetOrder() > 0)
+      { throw Exception("ADS only works for lowest order HDiv (order=0)!"); }
+
+    PCSetType(GetPETScPC(), PCHYPRE);
+    PCHYPRESetType(GetPETScPC(), "ads");
+  }
+
+
+  PETScHypreADS :: PETScHypreADS (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname)
+    : PETScHypreAuxiliarySpacePC (_apde, _aflags, _aname)
+  {
+    throw Exception("PETScHypreADS PDE-constructor not implemented. (Who still uses PDE files ... ?");
+  }
+
+
+  PETScHypreADS :: PETScHypreADS (shared_ptr<PETScBaseMatrix> _petsc_amat, shared_ptr<PETScBaseMatrix> _petsc_pmat,
+				  string _name, FlatArray<string> _petsc_options)
+    : PETScHypreAuxiliarySpacePC (_petsc_amat, _petsc_pmat, _name, _petsc_options, false) // set up in FinalizeLevel, with G and C
+  {
+    PCSetType(GetPETScPC(), PCHYPRE);
+    PCHYPRESetType(GetPETScPC(), "ads");
+  }
+
+
+  void PETScHypreADS :: CreateAuxiliarySpaceMatrices (shared_ptr<ngs::FESpace> fes, shared_ptr<ngs::BitArray> hd_subset)
+  {
+    static ngs::Timer t("PETScHypreADS::CreateAuxiliarySpaceMatrices"); ngs::RegionTimer rt(t);
+
+    auto feshd = dynamic_pointer_cast<ngs::HDivHighOrderFESpace>(fes);
+    if (feshd == nullptr)
+      { throw Exception(string("ADS does not work for space") + typeid(fes).name() + string("!!")); }
+    if (feshd->GetOrder() > 0)
+      { throw Exception("ADS only works for lowest order HDiv (order=0)!"); }
+    auto ma = feshd->GetMeshAccess();
+
+    // hypre's auxiliary spaces are lowest order Nedelec and P1
+    ngs::Flags hc_flags;
+    hc_flags.SetFlag("order", 0);
+    auto feshc = dynamic_pointer_cast<ngs::HCurlHighOrderFESpace>(ngs::CreateFESpace("hcurlho", ma, hc_flags));
+    feshc->Update();
+    feshc->FinalizeUpdate();
+    auto fesh1 = feshc->CreateGradientSpace();
+
+    LocalHeap lh(10 * 1024 * 1024, "ads_aux_spaces");
+
+    // curl is exact in the HDiv space, so the local projection is the discrete curl
+    shared_ptr<ngs::BaseMatrix> curl = ngs::ConvertOperator(feshc, feshd, ngs::VOL, lh, feshc->GetFluxEvaluator(),
+							    nullptr, NULL, nullptr, false, false);
+    shared_ptr<ngs::BaseMatrix> grad = feshc->CreateGradient(*fesh1);
+
+    // the auxiliary spaces have no Dirichlet-BCs, their free DOFs come from the HDiv ones
+    auto hc_subset = AuxiliarySubSet(curl, hd_subset, feshc);
+    auto h1_subset = AuxiliarySubSet(grad, hc_subset, fesh1);
+
+    SetVertexCoordinates(VertexCoordinates(fesh1));
+
+    if (feshd->IsParallel()) {
+      curl = make_shared<ngs::ParallelMatrix>(curl, feshc->GetParallelDofs(), feshd->GetParallelDofs(), ngs::PARALLEL_OP::C2C);
+      grad = make_shared<ngs::ParallelMatrix>(grad, fesh1->GetParallelDofs(), feshc->GetParallelDofs(), ngs::PARALLEL_OP::C2C);
+    }
+
+    curl_mat = make_shared<PETScMatrix> (curl, hc_subset, hd_subset);
+    grad_mat = make_shared<PETScMatrix> (grad, h1_subset, hc_subset, nullptr, curl_mat->GetRowMap());
+  } // PETScHypreADS::CreateAuxiliarySpaceMatrices
+
+
+  void PETScHypreADS :: InitLevel (shared_ptr<ngs::BitArray> freedofs)
+  {
+    PETSc2NGsPrecond :: InitLevel (freedofs);
+
+    if ( bfa == nullptr )
+      { throw Exception("PETScHypreADS::InitLevel called, but we have no bilinearform. How did we get here??"); }
+
+    auto ma = bfa->GetMeshAccess();
+
+    if ( own_aux && !AuxDataValid(ma, subset) ) { // mesh or free DOFs changed, drop what we built
+      curl_mat = grad_mat = nullptr;
+      coords.SetSize0();
+      own_aux = false;
+    }
+
+    if ( (curl_mat == nullptr) || (grad_mat == nullptr) ) { // try to construct them here
+      CreateAuxiliarySpaceMatrices(bfa->GetFESpace(), subset);
+      SetAuxDataBuilt(ma, subset);
     }
+  }
+
+
+  void PETScHypreADS :: FinalizeLevel (const ngs::BaseMatrix * mat)
+  {
+    // re-use vec-map if possible
+    shared_ptr<NGs2PETScVecMap> vec_map = (curl_mat != nullptr) ? curl_mat->GetColMap() : nullptr;
+    if ( (petsc_amat == nullptr) || // probably build via RegisterPreconditioner - convert matrix
+	 ( (mat != nullptr) && ( (petsc_amat->GetNGsMat().get() != mat) || (petsc_amat->GetRowMap() != vec_map) ) ) ) { // new level
+      if (mat == nullptr)
+	{ throw Exception("PETScHypreADS::FinalizeLevel, have no matrix!"); }
+      petsc_pmat = petsc_amat = make_shared<PETScMatrix> (shared_ptr<BaseMatrix>(const_cast<BaseMatrix*>(mat), NOOP_Deleter),
+							  subset, subset, vec_map, vec_map);
+    }
+    else if (mat != nullptr) // same matrix, maybe re-assembled
+      { petsc_amat->UpdateValues(); }
+
+    if ( (grad_mat == nullptr) || (curl_mat == nullptr) )
+      { throw Exception("The ADS Preconditioner needs the discrete gradient and curl Matrices!"); }
+
+    PCHYPRESetDiscreteGradient(GetPETScPC(), grad_mat->GetPETScMat());
+    PCHYPRESetDiscreteCurl(GetPETScPC(), curl_mat->GetPETScMat());
 
     PETScHypreAuxiliarySpacePC :: FinalizeLevel (mat);
   }
 #endif
 
+  PETScBDDCPC :: PETScBDDCPC (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags, const string _aname)
+    : PETSc2NGsPrecond(_bfa, _aflags, _aname)
+  {
+    PCSetType(GetPETScPC(), PCBDDC);
+  }
+
+
+  PETScBDDCPC :: PETScBDDCPC (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname)
+    : PETSc2NGsPrecond(_apde, _aflags, _aname)
+  {
+    throw Exception("PETScBDDCPC PDE-constructor not implemented. (Who still uses PDE files ... ?");
+  }
+
+
+  PETScBDDCPC :: PETScBDDCPC (shared_ptr<PETScBaseMatrix> _petsc_amat, shared_ptr<PETScBaseMatrix> _petsc_pmat,
+			      string _name, FlatArray<string> _petsc_options)
+    : PETSc2NGsPrecond(_petsc_amat, _petsc_pmat, _name, _petsc_options, nullptr, false) // set up in FinalizeLevel, MATIS has no default PC
+  {
+    PCSetType(GetPETScPC(), PCBDDC);
+  }
+
+
+  void PETScBDDCPC :: FinalizeLevel (const ngs::BaseMatrix * mat)
+  {
+    if (petsc_amat == nullptr) { // probably build via RegisterPreconditioner - convert matrix
+      if (mat == nullptr)
+	{ throw Exception("PETScBDDCPC::FinalizeLevel, have no matrix!"); }
+      // BDDC works on the subdomain matrices
+      petsc_pmat = petsc_amat = make_shared<PETScMatrix> (shared_ptr<BaseMatrix>(const_cast<BaseMatrix*>(mat), NOOP_Deleter),
+							  subset, subset, PETScMatrix::IS_AIJ);
+    }
+
+    auto pmat = (petsc_pmat != nullptr) ? petsc_pmat : petsc_amat;
+    PetscBool is_matis; PetscObjectTypeCompare((PetscObject)pmat->GetPETScMat(), MATIS, &is_matis);
+    if (!is_matis)
+      { throw Exception("PETScBDDCPC needs a MATIS, convert the (parallel) matrix with format IS_AIJ or IS_BAIJ!"); }
+
+    if (fes != nullptr)
+      { SetUpBDDC(); }
+
+    PETSc2NGsPrecond :: FinalizeLevel (mat);
+  }
+
+
+  void PETScBDDCPC :: SetUpBDDC ()
+  {
+    static ngs::Timer t("PETScBDDCPC::SetUpBDDC"); ngs::RegionTimer rt(t);
+
+    auto pmat = (petsc_pmat != nullptr) ? petsc_pmat : petsc_amat;
+    auto map = pmat->GetRowMap();
+    auto pardofs = map->GetParallelDofs();
+    auto dof_map = map->GetDOFMap();
+    int bs = map->GetBS();
+    auto ma = fes->GetMeshAccess();
+    int mdim = ma->GetDimension();
+
+    if (map->IsInterleaved())
+      { throw Exception("PETScBDDCPC: interleaved maps are not supported!"); }
+    if (map->GetNDof() != fes->GetNDof())
+      { throw Exception("PETScBDDCPC: matrix does not fit to the FESpace!"); }
+
+    // local numbering of the MATIS: the DOFs of the vector map, in order (see NGs2PETScVecMap::GetISMap)
+    Array<PETScInt> loc_nr(map->GetNDof());
+    size_t nloc = 0;
+    for (auto k : Range(loc_nr))
+      { loc_nr[k] = (dof_map[k] != -1) ? nloc++ : -1; }
+
+    auto append_rows = [&] (Array<PETScInt> & rows, int dof) {
+      for (auto l : Range(bs))
+	{ rows.Append(bs * loc_nr[dof] + l); }
+    };
+
+    auto set_local_is = [&] (FlatArray<PETScInt> rows, auto set_func) {
+      PETScIS is;
+      ISCreateGeneral(PETSC_COMM_SELF, rows.Size(), rows.Data(), PETSC_COPY_VALUES, &is);
+      set_func(GetPETScPC(), is);
+      ISDestroy(&is);
+    };
+
+    /** DOF adjacency: DOFs that share an element **/
+    Array<int> dnums;
+    Array<PETScInt> ldnums;
+    auto el_loc_dofs = [&] (size_t elnr) {
+      fes->GetDofNrs(ngs::ElementId(ngs::VOL, elnr), dnums);
+      ldnums.SetSize0();
+      for (auto d : dnums)
+	if ( (d >= 0) && (loc_nr[d] != -1) )
+	  { ldnums.Append(loc_nr[d]); }
+    };
+    Array<size_t> first(nloc + 1); first = 0;
+    for (auto elnr : Range(ma->GetNE(ngs::VOL))) {
+      el_loc_dofs(elnr);
+      for (auto i : ldnums)
+	{ first[i + 1] += ldnums.Size(); }
+    }
+    for (auto k : Range(nloc))
+      { first[k + 1] += first[k]; }
+    Array<PETScInt> all_adj(first.Last());
+    Array<size_t> pos(nloc);
+    for (auto k : Range(nloc))
+      { pos[k] = first[k]; }
+    for (auto elnr : Range(ma->GetNE(ngs::VOL))) {
+      el_loc_dofs(elnr);
+      for (auto i : ldnums)
+	for (auto j : ldnums)
+	  { all_adj[pos[i]++] = j; }
+    }
+    // unique per DOF, and expand DOFs to bs rows
+    Array<PETScInt> xadj(bs * nloc + 1), adjncy;
+    xadj[0] = 0;
+    Array<PETScInt> row;
+    for (auto i : Range(nloc)) {
+      auto dof_adj = all_adj.Range(first[i], first[i + 1]);
+      QuickSort(dof_adj);
+      row.SetSize0();
+      for (auto j : dof_adj)
+	if ( (row.Size() == 0) || (row.Last() != j) )
+	  { row.Append(j); }
+      for (auto l : Range(bs)) {
+	for (auto j : row)
+	  for (auto lj : Range(bs))
+	    { adjncy.Append(bs * j + lj); }
+	xadj[bs * i + l + 1] = adjncy.Size();
+      }
+    }
+    PCBDDCSetLocalAdjacencyGraph(GetPETScPC(), bs * nloc, xadj.Data(), adjncy.Data(), PETSC_COPY_VALUES);
+
+    /**
+       Primal vertices: vertex-DOFs shared by at least dim other ranks (subdomain corners), and vertex-DOFs shared by
+       dim-1 other ranks where the subdomain edge (3d) / face (2d) they are on ends or branches, i.e. they do not have
+       exactly two mesh-neighbours shared by the same ranks.
+    **/
+    if (pardofs != nullptr) {
+      Array<int> vdofs;
+      auto vertex_dof = [&] (size_t vnr) -> int {
+	fes->GetDofNrs(ngs::NodeId(ngs::NT_VERTEX, vnr), vdofs);
+	for (auto d : vdofs)
+	  if ( (d >= 0) && (loc_nr[d] != -1) )
+	    { return d; }
+	return -1;
+      };
+      Array<int> vdof(ma->GetNV());
+      for (auto vnr : Range(vdof))
+	{ vdof[vnr] = vertex_dof(vnr); }
+      auto nshared = [&] (int d) -> size_t { return (d == -1) ? 0 : pardofs->GetDistantProcs(d).Size(); };
+      auto same_procs = [&] (int d1, int d2) {
+	auto p1 = pardofs->GetDistantProcs(d1), p2 = pardofs->GetDistantProcs(d2);
+	if (p1.Size() != p2.Size())
+	  { return false; }
+	for (auto k : Range(p1))
+	  if (p1[k] != p2[k])
+	    { return false; }
+	return true;
+      };
+      Array<int> n_same(ma->GetNV()); n_same = 0;
+      for (auto enr : Range(ma->GetNEdges())) {
+	auto pnums = ma->GetEdgePNums(enr);
+	int d0 = vdof[pnums[0]], d1 = vdof[pnums[1]];
+	if ( (nshared(d0) == size_t(mdim - 1)) && (nshared(d1) == size_t(mdim - 1)) && same_procs(d0, d1) )
+	  { n_same[pnums[0]]++; n_same[pnums[1]]++; }
+      }
+      Array<PETScInt> primal;
+      for (auto vnr : Range(vdof)) {
+	auto ns = nshared(vdof[vnr]);
+	if ( (ns >= size_t(mdim)) || ( (ns == size_t(mdim - 1)) && (n_same[vnr] != 2) ) ) {
+	  fes->GetDofNrs(ngs::NodeId(ngs::NT_VERTEX, vnr), vdofs);
+	  for (auto d : vdofs)
+	    if ( (d >= 0) && (loc_nr[d] != -1) )
+	      { append_rows(primal, d); }
+	}
+      }
+      set_local_is(primal, PCBDDCSetPrimalVerticesLocalIS);
+    }
+
+    /**
+       Dirichlet-DOFs are usually not in the matrix at all (freedofs), but they can be if the matrix
+       was converted without subset. Neumann-DOFs are the remaining ones on the boundary.
+    **/
+    Array<PETScInt> dirichlet, neumann;
+    for (auto k : Range(loc_nr))
+      if ( (loc_nr[k] != -1) && fes->IsDirichletDof(k) )
+	{ append_rows(dirichlet, k); }
+    BitArray on_bnd(loc_nr.Size()); on_bnd.Clear();
+    for (auto elnr : Range(ma->GetNE(ngs::BND))) {
+      fes->GetDofNrs(ngs::ElementId(ngs::BND, elnr), dnums);
+      for (auto d : dnums)
+	if ( (d >= 0) && (loc_nr[d] != -1) && !fes->IsDirichletDof(d) )
+	  { on_bnd.SetBit(d); }
+    }
+    for (auto k : Range(loc_nr))
+      if (on_bnd.Test(k))
+	{ append_rows(neumann, k); }
+    if (dirichlet.Size())
+      { set_local_is(dirichlet, PCBDDCSetDirichletBoundariesLocal); }
+    if (neumann.Size())
+      { set_local_is(neumann, PCBDDCSetNeumannBoundariesLocal); }
+  } // PETScBDDCPC::SetUpBDDC
+
+
   FSField :: FSField (shared_ptr<PETScBasePrecond> _pc, string _name)
     : pc(_pc), name(_name)
   { ; }
@@ -404,6 +933,8 @@ namespace ngs_petsc_interface
   void FSFieldRange :: SetUpIS (shared_ptr<PETScBaseMatrix> mat, size_t _first, size_t _next)
   {
     auto row_map = mat->GetRowMap();
+    if (row_map->IsInterleaved())
+      { throw Exception("FSFieldRange: DOF ranges are not supported for interleaved maps!"); }
     auto dof_map = row_map->GetDOFMap();
     Array<PetscInt> inds(_next - _first);
     size_t cnt = 0;
@@ -415,7 +946,7 @@ namespace ngs_petsc_interface
     inds.SetSize(cnt);
     auto pardofs = row_map->GetParallelDofs();
     MPI_Comm comm = (pardofs != nullptr) ? MPI_Comm(pardofs->GetCommunicator()) : PETSC_COMM_SELF;
-    ISCreateGeneral (comm, cnt, &inds[0], PETSC_COPY_VALUES, &is);
+    ISCreateGeneral (comm, cnt, &inds[0], PETSC_COPY_VALUES, &is.Get());
   }
 
 
@@ -471,9 +1002,11 @@ namespace ngs_petsc_interface
 
 
   ngs::RegisterPreconditioner<PETSc2NGsPrecond> registerPETSc2NGsPrecond("petsc_pc");
+  ngs::RegisterPreconditioner<PETScBDDCPC> registerPETScBDDCPC("petsc_pc_bddc");
 
 #ifdef PETSC_HAVE_HYPRE
   ngs::RegisterPreconditioner<PETScHypreAMS> registerPETScHypreAMS("petsc_pc_hypre_ams");
+  ngs::RegisterPreconditioner<PETScHypreADS> registerPETScHypreADS("petsc_pc_hypre_ads");
 #endif
 
 } // namespace ngs_petsc_interface
@@ -521,11 +1054,13 @@ namespace ngs_petsc_interface {
     py::class_<PETSc2NGsPrecond, shared_ptr<PETSc2NGsPrecond>, PETScBasePrecond, ngs::BaseMatrix>
       (m, "PETSc2NGsPrecond", "A Preconditioner built in PETsc")
       .def (py::init<>
-	    ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options)
+	    ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options, shared_ptr<ngs::FESpace> fes)
 	     {
 	       auto opt_array = Dict2SA(petsc_options);
-	       return make_shared<PETSc2NGsPrecond>(amat, amat, name, opt_array);
-	     }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict())
+	       return make_shared<PETSc2NGsPrecond>(amat, amat, name, opt_array, fes);
+	     }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(), py::arg("fes") = nullptr,
+	    docu_string(R"raw_string(
+If an H1/VectorH1 space is given, it is used for rigid body modes and coordinates.)raw_string"))
       .def("Finalize", [](shared_ptr<PETSc2NGsPrecond> & pc)
 	   { pc->FinalizeLevel(); } );
 
@@ -534,6 +1069,8 @@ namespace ngs_petsc_interface {
       (m, "HypreAuxiliarySpacePrecond", "ADS/AMS from hypre package")
       .def ("SetGradientMatrix"      , [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, shared_ptr<PETScMatrix> mat)
 	    { pc->SetGradientMatrix(mat); })
+      .def ("SetCurlMatrix"          , [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, shared_ptr<PETScMatrix> mat)
+	    { pc->SetCurlMatrix(mat); })
       .def ("SetHCurlEmbeddingMatrix", [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, shared_ptr<PETScMatrix> mat)
 	    { pc->SetHCurlEmbeddingMatrix(mat); })
       .def ("SetHDivEmbeddingMatrix" , [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, shared_ptr<PETScMatrix> mat)
@@ -545,7 +1082,14 @@ namespace ngs_petsc_interface {
       .def ("SetConstantVectors"     , [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, shared_ptr<ngs::BaseVector> ozz,
 					  shared_ptr<ngs::BaseVector> zoz, shared_ptr<ngs::BaseVector> zzo)
 	    { pc->SetConstantVectors(ozz, zoz, zzo); },
-	    py::arg("ozz"), py::arg("zoz"), py::arg("zzo") = nullptr);
+	    py::arg("ozz"), py::arg("zoz"), py::arg("zzo") = nullptr)
+      .def ("SetVertexCoordinates"   , [](shared_ptr<PETScHypreAuxiliarySpacePC> & pc, py::list coords)
+	    {
+	      Array<shared_ptr<ngs::BaseVector>> vecs;
+	      for (auto c : coords)
+		{ vecs.Append(c.cast<shared_ptr<ngs::BaseVector>>()); }
+	      pc->SetVertexCoordinates(vecs);
+	    }, py::arg("coords"), "x, y (and z) coordinates in the H1 basis of the gradient matrix");
 
     py::class_<PETScHypreAMS, shared_ptr<PETScHypreAMS>, PETScHypreAuxiliarySpacePC>
       (m, "HypreAMSPrecond", "Auxiliary Maxwell Space Preconditioner from hypre")
@@ -563,6 +1107,31 @@ namespace ngs_petsc_interface {
 	       return pc;
 	     }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(),
 	    py::arg("grad_mat") = nullptr);
+
+    py::class_<PETScHypreADS, shared_ptr<PETScHypreADS>, PETScHypreAuxiliarySpacePC>
+      (m, "HypreADSPrecond", docu_string(R"raw_string(
+Auxiliary Divergence Space Preconditioner from hypre, for lowest order H(div) in 3d.
+Either give the discrete gradient and curl matrices, or the HDiv space, then they are built
+from lowest order HCurl and H1 spaces. The HDiv space has to be lowest order (order=0),
+higher order spaces throw. Call Finalize when done.)raw_string"))
+      .def (py::init<>
+	    ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options,
+		shared_ptr<PETScMatrix> grad_mat, shared_ptr<PETScMatrix> curl_mat, shared_ptr<ngs::FESpace> fes)
+	     {
+	       auto opt_array = Dict2SA(petsc_options);
+
+	       auto pc = make_shared<PETScHypreADS>(amat, amat, name, opt_array);
+
+	       if (fes != nullptr)
+		 { pc->CreateAuxiliarySpaceMatrices(fes, amat->GetColMap()->GetSubSet()); }
+	       if (grad_mat != nullptr)
+		 { pc->SetGradientMatrix(grad_mat); }
+	       if (curl_mat != nullptr)
+		 { pc->SetCurlMatrix(curl_mat); }
+
+	       return pc;
+	     }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(),
+	    py::arg("grad_mat") = nullptr, py::arg("curl_mat") = nullptr, py::arg("fes") = nullptr);
 #else
     m.def ("HypreAMSPrecond",
 	   ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options,
@@ -571,8 +1140,31 @@ namespace ngs_petsc_interface {
 	      throw Exception("NGs-PETSc Interface built without HYPRE Support");
 	    }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(),
 	   py::arg("grad_mat") = nullptr);
+    m.def ("HypreADSPrecond",
+	   ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options,
+	       shared_ptr<PETScMatrix> grad_mat, shared_ptr<PETScMatrix> curl_mat, shared_ptr<ngs::FESpace> fes)
+	    {
+	      throw Exception("NGs-PETSc Interface built without HYPRE Support");
+	    }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(),
+	   py::arg("grad_mat") = nullptr, py::arg("curl_mat") = nullptr, py::arg("fes") = nullptr);
 #endif
 
+    py::class_<PETScBDDCPC, shared_ptr<PETScBDDCPC>, PETSc2NGsPrecond>
+      (m, "BDDCPrecond", docu_string(R"raw_string(
+BDDC from PETSc, on a matrix in IS_AIJ or IS_BAIJ format. If the FESpace is given, the PC
+gets the local DOF adjacency, primal vertex candidates from the mesh topology, Dirichlet and
+Neumann DOFs and rigid body modes (H1/VectorH1) from it. Call Finalize when done.)raw_string"))
+      .def (py::init<>
+	    ([](shared_ptr<PETScBaseMatrix> amat, string name, py::dict petsc_options, shared_ptr<ngs::FESpace> fes)
+	     {
+	       auto opt_array = Dict2SA(petsc_options);
+	       auto pc = make_shared<PETScBDDCPC>(amat, amat, name, opt_array);
+	       if (fes != nullptr)
+		 { pc->SetFESpace(fes); }
+	       return pc;
+	     }), py::arg("mat"), py::arg("name") = "", py::arg("petsc_options") = py::dict(),
+	    py::arg("fes") = nullptr);
+
     py::class_<PETScFieldSplitPC, shared_ptr<PETScFieldSplitPC>, PETSc2NGsPrecond>
       (m, "FieldSplitPrecond", "Fieldsplit Preconditioner from PETSc")
       .def (py::init<>
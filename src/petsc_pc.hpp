@@ -14,7 +14,7 @@ namespace ngs_petsc_interface
 		      string _name = "", FlatArray<string> _petsc_options = Array<string>());
 
     virtual PETScPC GetPETScPC () const { return petsc_pc; }
-    virtual PETScPC& GetPETScPC () { return petsc_pc; }
+    virtual PETScPC& GetPETScPC () { return petsc_pc.Get(); }
 
     shared_ptr<PETScBaseMatrix> GetAMat () const { return petsc_amat; }
     void SetAMat (shared_ptr<PETScBaseMatrix> _petsc_amat) { petsc_amat = _petsc_amat; }
@@ -28,10 +28,10 @@ namespace ngs_petsc_interface
     virtual void Finalize ();
 
   protected:
-    PETScPC petsc_pc;
+    PETScHandle<PETScPC> petsc_pc;
     shared_ptr<PETScBaseMatrix> petsc_amat; // the matrix this is a PC for
     shared_ptr<PETScBaseMatrix> petsc_pmat; // the matrix this PC is built from (usually same as amat)
-    PETScVec petsc_rhs, petsc_sol;
+    PETScHandle<PETScVec> petsc_rhs, petsc_sol;
     string name;
   };
 
@@ -52,9 +52,8 @@ namespace ngs_petsc_interface
     NGs2PETScPrecond (shared_ptr<PETScBaseMatrix> _mat, shared_ptr<ngs::BaseMatrix> _ngs_pc,
 		      string name = "", FlatArray<string> _petsc_options = Array<string>(), bool _finalize = true);
 
-    ~NGs2PETScPrecond () { /* PCDestroy(&GetPETScPC()); */ }
-    
     static PetscErrorCode ApplyPC (PETScPC pc, PETScVec x, PETScVec y);
+    static PetscErrorCode MatApplyPC (PETScPC pc, PETScMat X, PETScMat Y);
   };
 
 
@@ -69,11 +68,14 @@ namespace ngs_petsc_interface
     // does not do anything, but we need to have it in oder to register the Preconditioner
     PETSc2NGsPrecond (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname = "petsc_precond");
 
+    // with an FESpace, near-nullspace and coordinates are set before the PC is finalized
+    // (without _finalize, FinalizeLevel has to be called later, e.g. when the PC type is set afterwards)
     PETSc2NGsPrecond (shared_ptr<PETScBaseMatrix> _petsc_amat = nullptr, shared_ptr<PETScBaseMatrix> _petsc_pmat = nullptr,
-		      string _name = "", FlatArray<string> _petsc_options = Array<string>())
-      : PETScBasePrecond(_petsc_amat, _petsc_pmat, _name, _petsc_options),
-	ngs::Preconditioner( shared_ptr<ngs::BilinearForm>(), ngs::Flags({"not_register_for_auto_update"}), _name)
-    { PETScBasePrecond::Finalize(); }
+		      string _name = "", FlatArray<string> _petsc_options = Array<string>(),
+		      shared_ptr<ngs::FESpace> _fes = nullptr, bool _finalize = true);
+
+    /** near-nullspace and coordinates come from here; set from the bilinearform if there is one **/
+    void SetFESpace (shared_ptr<ngs::FESpace> _fes) { fes = _fes; }
 
     virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override;
     virtual void MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const override;
@@ -87,8 +89,15 @@ namespace ngs_petsc_interface
     virtual void InitLevel (shared_ptr<ngs::BitArray> freedofs = nullptr) override;
     virtual void FinalizeLevel (const ngs::BaseMatrix * mat = nullptr) override;
     virtual void Update ()  override { ; }
+
+    /** operators, options, then what we know from the FESpace, then PCSetUp **/
+    virtual void Finalize () override;
   protected:
+    /** near-nullspace for the pmat and coordinates for the PC from the FESpace (after the operators and type are set) **/
+    void SetUpFromFESpace ();
+
     shared_ptr<ngs::BilinearForm> bfa;
+    shared_ptr<ngs::FESpace> fes;
     using PETScBasePrecond::name; // there is also a name in Preconditioner
     shared_ptr<BitArray> subset; // only used to stash freedofs given in InitLevel
   };
@@ -115,7 +124,7 @@ namespace ngs_petsc_interface
     PETScHypreAuxiliarySpacePC (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname = "petsc_hypre_precond");
 
     PETScHypreAuxiliarySpacePC (shared_ptr<PETScBaseMatrix> _petsc_amat = nullptr, shared_ptr<PETScBaseMatrix> _petsc_pmat = nullptr,
-				string _name = "", FlatArray<string> _petsc_options = Array<string>());
+				string _name = "", FlatArray<string> _petsc_options = Array<string>(), bool _finalize = true);
 
     void SetGradientMatrix (shared_ptr<PETScMatrix> _grad_mat) { grad_mat = _grad_mat; }
     // void SetGradientMatrix (shared_ptr<BaseMatrix> _grad_mat);
@@ -137,9 +146,19 @@ namespace ngs_petsc_interface
 
     void SetConstantVectors (shared_ptr<ngs::BaseVector> _ozz, shared_ptr<ngs::BaseVector> _zoz, shared_ptr<ngs::BaseVector> _zzo);
 
+    /** x/y/z-coordinates of the vertices, in the (scalar) H1 basis of the gradient matrix **/
+    void SetVertexCoordinates (FlatArray<shared_ptr<ngs::BaseVector>> _coords) { coords = Array<shared_ptr<ngs::BaseVector>>(_coords); }
+
     virtual void FinalizeLevel (const ngs::BaseMatrix * mat = nullptr) override;
 
   protected:
+    /** Auxiliary data we built ourselves stays valid as long as the mesh and the free DOFs do not change **/
+    bool AuxDataValid (shared_ptr<ngs::MeshAccess> ma, shared_ptr<ngs::BitArray> freedofs) const;
+    void SetAuxDataBuilt (shared_ptr<ngs::MeshAccess> ma, shared_ptr<ngs::BitArray> freedofs);
+    bool own_aux = false;                  // we built the auxiliary data ourselves
+    size_t aux_timestamp = 0;              // mesh timestamp and free DOFs we built it for
+    shared_ptr<ngs::BitArray> aux_freedofs;
+
     PetscInt dimension = 3;                // dimension (used for AMS)
     shared_ptr<PETScMatrix> grad_mat;      // (scalar) H1 -> HC gradient matrix
     shared_ptr<PETScMatrix> curl_mat;      // HC -> HD curl
@@ -148,6 +167,7 @@ namespace ngs_petsc_interface
     shared_ptr<PETScMatrix> alpha_mat;     // vector stiffness matrix
     shared_ptr<PETScMatrix> beta_mat;      // scalar stiffness matrix
     shared_ptr<ngs::BaseVector> ozz, zoz, zzo;  // (1,0,0), (0,1,0) and (0,0,1) in HC basis
+    Array<shared_ptr<ngs::BaseVector>> coords;   // vertex coordinates in H1 basis
   };
 
 
@@ -168,12 +188,55 @@ namespace ngs_petsc_interface
   };
 
 
-  // class PETScHypreADS : public PETScHypreAuxiliarySpacePC
-  // {
+  /**
+     Auxiliary Divergence Space PC from hypre, for (lowest order) H(div) problems in 3d.
+     If it has an HDiv space, it builds the discrete curl from a lowest order HCurl space, the discrete gradient
+     from the H1 space below that and the vertex coordinates by itself. That HDiv space has to be of order 0.
+  **/
+  class PETScHypreADS : public PETScHypreAuxiliarySpacePC
+  {
+  public:
+    PETScHypreADS (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags,
+		   const string _aname = "petsc_hypre_ads_precond");
 
-  // };
+    PETScHypreADS (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname = "petsc_hypre_ads_precond");
+
+    PETScHypreADS (shared_ptr<PETScBaseMatrix> _petsc_amat = nullptr, shared_ptr<PETScBaseMatrix> _petsc_pmat = nullptr,
+		   string _name = "", FlatArray<string> _petsc_options = Array<string>());
+
+    /** builds curl- and gradient matrix and coordinates; hd_subset are the DOFs of the HDiv space the PC works on **/
+    void CreateAuxiliarySpaceMatrices (shared_ptr<ngs::FESpace> fes, shared_ptr<ngs::BitArray> hd_subset);
+
+    virtual void InitLevel (shared_ptr<ngs::BitArray> freedofs = nullptr) override;
+
+    virtual void FinalizeLevel (const ngs::BaseMatrix * mat = nullptr) override;
+  };
 #endif
 
+  /**
+     Balancing Domain Decomposition by Constraints (PCBDDC) on the subdomain matrices of a MATIS.
+     From the FESpace, the PC gets the local DOF adjacency, primal vertex candidates (subdomain corners and the
+     ends of subdomain edges, from the mesh topology), Dirichlet- and Neumann-DOFs and the near-nullspace.
+     All of this is local, there is no communication in the setup on our side.
+   **/
+  class PETScBDDCPC : public PETSc2NGsPrecond
+  {
+  public:
+    PETScBDDCPC (shared_ptr<ngs::BilinearForm> _bfa, const ngs::Flags & _aflags,
+		 const string _aname = "petsc_bddc_precond");
+
+    PETScBDDCPC (const ngs::PDE & _apde, const ngs::Flags & _aflags, const string _aname = "petsc_bddc_precond");
+
+    PETScBDDCPC (shared_ptr<PETScBaseMatrix> _petsc_amat = nullptr, shared_ptr<PETScBaseMatrix> _petsc_pmat = nullptr,
+		 string _name = "", FlatArray<string> _petsc_options = Array<string>());
+
+    virtual void FinalizeLevel (const ngs::BaseMatrix * mat = nullptr) override;
+
+  protected:
+    void SetUpBDDC ();
+  };
+
+
   class FSField
   {
   public:
@@ -182,7 +245,7 @@ namespace ngs_petsc_interface
     shared_ptr<PETScBasePrecond> GetPC () const { return pc; }
     string GetName () const { return name; }
   protected:
-    PETScIS is;
+    PETScHandle<PETScIS> is;
     shared_ptr<PETScBasePrecond> pc;
     string name;
   };
@@ -30,13 +30,248 @@ namespace ngs_petsc_interface
   }
 
 
+  INLINE bool HasSkeletonIntegrators (ngs::BilinearForm & blf)
+  {
+    for (auto k : Range(blf.NumIntegrators()))
+      if (blf.GetIntegrator(k)->SkeletonForm())
+	{ return true; }
+    return false;
+  } // HasSkeletonIntegrators
+
+
+  /** integrators on co-dimension 2 or 3 (BBND, BBBND) **/
+  INLINE bool HasCoDimIntegrators (ngs::BilinearForm & blf)
+  {
+    for (auto k : Range(blf.NumIntegrators()))
+      if ( (blf.GetIntegrator(k)->VB() != ngs::VOL) && (blf.GetIntegrator(k)->VB() != ngs::BND) )
+	{ return true; }
+    return false;
+  } // HasCoDimIntegrators
+
+
+  /**
+     One loop over the elements of blf at lin (cumulated): F(lin) is written to res (if given), and
+     the element matrices of F'(lin) are handed to elmat_func(ei, dnums, elmat).
+     Elements are colored, elmat_func is never called concurrently for elements that share DOFs.
+  **/
+  template<class TFUNC>
+  INLINE void IterateLinearization (ngs::BilinearForm & blf, const ngs::BaseVector & lin, ngs::BaseVector * res,
+				    LocalHeap & lh, TFUNC elmat_func)
+  {
+    auto fes = blf.GetTrialSpace();
+    int dim = fes->GetDimension();
+
+    if (HasCoDimIntegrators(blf))
+      { throw Exception("IterateLinearization can only handle VOL and BND integrators!"); }
+
+    if (res != nullptr)
+      { *res = 0.0; }
+
+    for (auto vb : { ngs::VOL, ngs::BND }) {
+      Array<shared_ptr<ngs::BilinearFormIntegrator>> bfis;
+      for (auto k : Range(blf.NumIntegrators()))
+	if (blf.GetIntegrator(k)->VB() == vb)
+	  { bfis.Append(blf.GetIntegrator(k)); }
+      if (!bfis.Size())
+	{ continue; }
+      ngs::IterateElements(*fes, vb, lh, [&] (ngs::FESpace::Element el, LocalHeap & llh) {
+	  auto dnums = el.GetDofs();
+	  size_t n = dnums.Size() * dim;
+	  ngs::FlatVector<double> elveclin(n, llh), elres(n, llh), sum_elres(n, llh);
+	  ngs::FlatMatrix<double> elmat(n, n, llh), sum_elmat(n, n, llh);
+	  lin.GetIndirect(dnums, elveclin);
+	  fes->TransformVec(el, elveclin, ngs::TRANSFORM_SOL);
+	  sum_elmat = 0.0; sum_elres = 0.0;
+	  for (auto & bfi : bfis) {
+	    if (!bfi->DefinedOn(el.GetIndex()))
+	      { continue; }
+	    bfi->CalcLinearizedElementMatrix(el.GetFE(), el.GetTrafo(), elveclin, elmat, llh);
+	    sum_elmat += elmat;
+	    if (res != nullptr) {
+	      bfi->ApplyElementMatrix(el.GetFE(), el.GetTrafo(), elveclin, elres, nullptr, llh);
+	      sum_elres += elres;
+	    }
+	  }
+	  fes->TransformMat(el, sum_elmat, ngs::TRANSFORM_MAT_LEFT_RIGHT);
+	  elmat_func(ngs::ElementId(el), dnums, sum_elmat);
+	  if (res != nullptr) {
+	    fes->TransformVec(el, sum_elres, ngs::TRANSFORM_RHS);
+	    res->AddIndirect(dnums, sum_elres);
+	  }
+	});
+    }
+
+    if (res != nullptr)
+      { res->SetParallelStatus(ngs::DISTRIBUTED); }
+  } // IterateLinearization
+
+
+  CachedLinearization :: CachedLinearization (shared_ptr<ngs::BilinearForm> _blf)
+    : blf(_blf)
+  {
+    static ngs::Timer t("CachedLinearization - constructor"); ngs::RegionTimer rt(t);
+
+    auto fes = blf->GetTrialSpace();
+    auto ma = fes->GetMeshAccess();
+    dim = fes->GetDimension();
+
+    if (HasSkeletonIntegrators(*blf))
+      { throw Exception("CachedLinearization can not handle skeleton integrators!"); }
+    if (HasCoDimIntegrators(*blf))
+      { throw Exception("CachedLinearization can only handle VOL and BND integrators!"); }
+
+    el_first[ngs::VOL] = 0;
+    el_first[ngs::BND] = ma->GetNE(ngs::VOL);
+    size_t nel = el_first[ngs::BND] + ma->GetNE(ngs::BND);
+
+    // the DOFs do not change between linearizations, only the element matrices
+    dof_first.SetSize(nel + 1); dof_first[0] = 0;
+    mat_first.SetSize(nel + 1); mat_first[0] = 0;
+    Array<int> dnums;
+    for (auto vb : { ngs::VOL, ngs::BND }) {
+      bool has_bfi = false;
+      for (auto k : Range(blf->NumIntegrators()))
+	{ has_bfi |= (blf->GetIntegrator(k)->VB() == vb); }
+      for (auto k : Range(ma->GetNE(vb))) {
+	size_t el = el_first[vb] + k;
+	dnums.SetSize0();
+	if (has_bfi)
+	  { fes->GetDofNrs(ngs::ElementId(vb, k), dnums); }
+	dofs.Append(dnums);
+	dof_first[el + 1] = dofs.Size();
+	mat_first[el + 1] = mat_first[el] + ngs::sqr(dnums.Size() * dim);
+      }
+    }
+    vals.SetSize(mat_first.Last()); vals = 0.0;
+  } // CachedLinearization
+
+
+  void CachedLinearization :: SetLinearization (const ngs::BaseVector & lin, LocalHeap & lh, ngs::BaseVector * res)
+  {
+    static ngs::Timer t("CachedLinearization::SetLinearization"); ngs::RegionTimer rt(t);
+
+    IterateLinearization(*blf, lin, res, lh, [&] (ngs::ElementId ei, FlatArray<int> dnums, ngs::FlatMatrix<double> elmat) {
+	size_t n = dnums.Size() * dim;
+	ngs::FlatMatrix<double> cached(n, n, &vals[mat_first[el_first[ei.VB()] + ei.Nr()]]);
+	cached = elmat;
+      });
+  } // CachedLinearization::SetLinearization
+
+
+  void CachedLinearization :: MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const
+  {
+    static ngs::Timer t("CachedLinearization::MultAdd"); ngs::RegionTimer rt(t);
+
+    auto fx = x.FV<double>();
+    auto fy = y.FV<double>();
+
+    ParallelForRange (Range(dof_first.Size() - 1), [&] (auto r) {
+	Array<double> ex, ey;
+	for (auto el : r) {
+	  auto eldofs = dofs.Range(dof_first[el], dof_first[el + 1]);
+	  size_t n = eldofs.Size() * dim;
+	  if (n == 0)
+	    { continue; }
+	  ex.SetSize(n); ey.SetSize(n);
+	  for (auto k : Range(eldofs.Size()))
+	    for (auto l : Range(dim))
+	      { ex[k * dim + l] = (eldofs[k] >= 0) ? fx(eldofs[k] * dim + l) : 0.0; }
+	  ngs::FlatMatrix<double> elmat(n, n, const_cast<double*>(&vals[mat_first[el]]));
+	  ngs::FlatVector<double> vex(n, ex.Data()), vey(n, ey.Data());
+	  vey = elmat * vex;
+	  // elements of the same thread-range can share DOFs with other ranges
+	  for (auto k : Range(eldofs.Size()))
+	    if (eldofs[k] >= 0)
+	      for (auto l : Range(dim))
+		{ AtomicAdd(fy(eldofs[k] * dim + l), scal * ey[k * dim + l]); }
+	}
+      });
+  } // CachedLinearization::MultAdd
+
+
+  FDLinearization :: FDLinearization (shared_ptr<ngs::BilinearForm> _blf, HeapRunner _run_with_heap, double _err)
+    : blf(_blf), run_with_heap(_run_with_heap), err(_err)
+  {
+    u = blf->CreateRowVector();
+    upert = blf->CreateRowVector();
+    fu = blf->CreateColVector();
+    fpert = blf->CreateColVector();
+  } // FDLinearization
+
+
+  void FDLinearization :: SetLinearization (const ngs::BaseVector & lin, const ngs::BaseVector & f_lin)
+  {
+    *u = lin;
+    *fu = f_lin;
+    lin_norm = u->L2Norm();
+  } // FDLinearization::SetLinearization
+
+
+  void FDLinearization :: MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const
+  {
+    static ngs::Timer t("FDLinearization::MultAdd"); ngs::RegionTimer rt(t);
+
+    // same choice of h as PETSc's MatMFFD with -mat_mffd_type wp
+    double xnorm = x.L2Norm();
+    if (xnorm == 0)
+      { return; }
+    double h = err * sqrt(1 + lin_norm) / xnorm;
+
+    *upert = *u;
+    upert->Add(h, x);
+    // (called from within KSP iterations, a heap overflow must not end up in MatMult)
+    run_with_heap([&] (LocalHeap & lh) { blf->ApplyMatrix(*upert, *fpert, lh); });
+
+    y.Add(scal / h, *fpert);
+    y.Add(-scal / h, *fu);
+  } // FDLinearization::MultAdd
+
+
+  void PETScSNES :: GrowHeap (size_t per_thread)
+  {
+    heap_per_thread = per_thread;
+    size_t size = heap_per_thread * ngs::TaskManager::GetMaxThreads();
+    // always a new heap, one handed in by the caller is theirs and stays as it is
+    use_lh = make_shared<LocalHeap>(size, "PETScSNES");
+  } // PETScSNES::GrowHeap
+
+
+  template<class TFUNC>
+  void PETScSNES :: RunWithHeap (TFUNC f)
+  {
+    while (true) {
+      try {
+	// does not restart the TaskManager if it is already running (e.g. in Solve)
+	ngs::RunWithTaskManager([&] () {
+	    HeapReset hr(*use_lh);
+	    f(*use_lh);
+	  });
+	break;
+      }
+      catch (ngs::LocalHeapOverflow &)
+	{ GrowHeap(2 * heap_per_thread); }
+      catch (ngs::Exception & ex) {
+	// the TaskManager re-throws exceptions from its threads as plain Exceptions, there only the message is left
+	if (ex.What().find("Local Heap overflow") == string::npos)
+	  { throw; }
+	GrowHeap(2 * heap_per_thread);
+      }
+    }
+  } // PETScSNES::RunWithHeap
+
+
   PETScSNES :: PETScSNES (shared_ptr<ngs::BilinearForm> _blf, FlatArray<string> _opts, string _name,
-			  shared_ptr<ngs::LocalHeap> _lh, JACOBI_MAT_MODE _jac_mode)
-    : blf(_blf), use_lh(_lh), mode(_jac_mode)
+			  shared_ptr<ngs::LocalHeap> _lh, JACOBI_MAT_MODE _jac_mode,
+			  shared_ptr<ngs::BilinearForm> _pc_blf)
+    : blf(_blf), use_lh(_lh), mode(_jac_mode), pc_blf(_pc_blf)
   {
 
+    // the heap is split among the threads of the TaskManager
+    int nthreads = ngs::TaskManager::GetMaxThreads();
     if (use_lh == nullptr)
-      { use_lh = make_shared<ngs::LocalHeap>(10*1024*1024); }
+      { GrowHeap(2*1024*1024); }
+    else
+      { heap_per_thread = use_lh->Available() / nthreads; }
 
     auto pardofs = blf->GetTrialSpace()->GetParallelDofs();
     bool parallel = pardofs != nullptr;
@@ -62,23 +297,36 @@ namespace ngs_petsc_interface
     auto tss = blf->GetTrialSpace();
     auto col_map = make_shared<NGs2PETScVecMap>(tss->GetNDof(), tss->GetDimension(), tss->GetParallelDofs(), tss->GetFreeDofs());
 
-    if (mode == APPLY) {
-      // This is currently broken in NGSolve. Also, even if fixed, it is terribly slow.
-      shared_ptr<ngs::BaseMatrix> lap = make_shared<ngs::LinearizedBilinearFormApplication>(blf, lin_vec.get(), *use_lh);
+    *lin_vec = 0;
+    if ( (mode == APPLY) || (mode == MFFD) ) {
+      shared_ptr<ngs::BaseMatrix> lap;
+      if (mode == APPLY)
+	{ lap = cached_lin = make_shared<CachedLinearization>(blf); }
+      else {
+	lap = fd_lin = make_shared<FDLinearization>(blf, [this] (const std::function<void(LocalHeap&)> & f) { RunWithHeap(f); });
+	f_vec = col_map->CreateNGsVector();
+      }
       if (parallel)
 	{ lap = make_shared<ngs::ParallelMatrix> (lap, blf->GetTrialSpace()->GetParallelDofs(), blf->GetTestSpace()->GetParallelDofs(), ngs::C2D); }
       jac_mat = make_shared<FlatPETScMatrix> (lap, nullptr, nullptr, row_map, col_map);
     }
     else {
       // assemble matrix once so it is allocated
-      *lin_vec = 0;
-      blf->AssembleLinearization (*lin_vec, *use_lh, false);
+      RunWithHeap([&] (LocalHeap & lh) { blf->AssembleLinearization (*lin_vec, lh, false); });
       if (mode == FLAT)
 	{ jac_mat = make_shared<FlatPETScMatrix> (blf->GetMatrixPtr(), row_fds, col_fds, row_map, col_map); }
       else if (mode == CONVERT) // IS makes UpdateValues easier
 	{ jac_mat = make_shared<PETScMatrix> (blf->GetMatrixPtr(), row_fds, col_fds, PETScMatrix::AIJ, row_map, col_map); }
     }
 
+    // matrix to build the PC from
+    if (pc_blf != nullptr) {
+      RunWithHeap([&] (LocalHeap & lh) { pc_blf->AssembleLinearization (*lin_vec, lh, false); });
+      pc_mat = make_shared<PETScMatrix> (pc_blf->GetMatrixPtr(), row_fds, col_fds, PETScMatrix::AIJ, row_map, col_map);
+    }
+    else
+      { pc_mat = jac_mat; }
+
     // buffer vectors
     row_vec = jac_mat->GetRowMap()->CreateNGsVector();
     col_vec = jac_mat->GetColMap()->CreateNGsVector();
@@ -92,6 +340,9 @@ namespace ngs_petsc_interface
     KSP snes_ksp; SNESGetKSP(GetSNES(), &snes_ksp);
     ksp = make_shared<PETScKSP> (jac_mat, snes_ksp);
 
+    // lets us time the KSP/PC setup that follows a jacobian evaluation
+    KSPSetPreSolve(snes_ksp, this->KSPPreSolve, (void*)this);
+
     // set prefix so we can define unique options for this SNES object
     string name = (_name.size()) ? _name : GetDefaultId();
     if (_name.size()) {
@@ -106,12 +357,14 @@ namespace ngs_petsc_interface
 
     // Create Vector to hold F(x)
     func_vec = jac_mat->GetRowMap()->CreatePETScVector();
+    f_cache = jac_mat->GetColMap()->CreatePETScVector();
+    x_cache = jac_mat->GetRowMap()->CreatePETScVector();
 
     // Set (non-linear) function evaluation, f = F(x)
     SNESSetFunction(GetSNES(), func_vec, this->EvaluateF, (void*)this);
 
     // Set evaluation of the Jacobian
-    SNESSetJacobian(GetSNES(), jac_mat->GetPETScMat(), jac_mat->GetPETScMat(), this->EvaluateJac, (void*)this);
+    SNESSetJacobian(GetSNES(), jac_mat->GetPETScMat(), pc_mat->GetPETScMat(), this->EvaluateJac, (void*)this);
 
     // Create a DM (DataManagement) shell - workaround for constructing vectors
     // DMShellCreate(comm, &petsc_dm);
@@ -136,8 +389,8 @@ namespace ngs_petsc_interface
 
   PETScSNES :: ~PETScSNES ()
   {
-    // SNESDestroy(&GetSNES());
-    // VecDestroy(&func_vec);
+    // the KSP wraps the one of the SNES
+    ksp = nullptr;
   }
 
 
@@ -153,12 +406,29 @@ namespace ngs_petsc_interface
   }
 
 
+  void PETScSNES :: SetLagging (int _jac_lag, int _pc_lag, bool _persists)
+  {
+    if ( (_jac_lag == 0) || (_jac_lag < -1) || (_pc_lag == 0) || (_pc_lag < -1) )
+      { throw Exception("PETScSNES::SetLagging: lags must be -1 or positive!"); }
+    jac_lag = _jac_lag;
+    // SNES decides about KSPSetReusePreconditioner after every jacobian evaluation, so we have to go through it here
+    SNESSetLagPreconditioner(GetSNES(), _pc_lag);
+    jac_persists = _persists;
+    SNESSetLagPreconditionerPersists(GetSNES(), _persists ? PETSC_TRUE : PETSC_FALSE);
+  } // PETScSNES::SetLagging
+
+
   void PETScSNES :: Solve (ngs::BaseVector & sol)
   {
     static ngs::Timer tt("PETSc::SNES::Solve - total");
     static ngs::Timer tp("PETSc::SNES::Solve - PETSc");
     RegionTimer rt(tt);
 
+    step_stats.SetSize0(); jac_pending = false;
+    x_valid = f_valid = lin_valid = false;
+    if (!jac_persists)
+      { have_jac = false; }
+
     jac_mat->GetRowMap()->NGs2PETSc(sol, sol_vec);
 
     // cout << "SNES RHS: " << endl;
@@ -166,13 +436,14 @@ namespace ngs_petsc_interface
 
     {
       RegionTimer rt(tp);
-      SNESSolve(GetSNES(), NULL, sol_vec);
+      // start the TaskManager once, not in every evaluation
+      ngs::RunWithTaskManager([&] () { SNESSolve(GetSNES(), NULL, sol_vec); });
     }
 
     // cout << "SNES SOL: " << sol_vec << endl;
     // VecView(sol_vec, PETSC_VIEWER_STDOUT_WORLD);
 
-    jac_mat->GetRowMap()->PETSc2NGs(sol, sol_vec);
+    jac_mat->GetRowMap()->PETSc2NGs(sol, sol_vec, ngs::CUMULATED);
 
   }
 
@@ -183,6 +454,11 @@ namespace ngs_petsc_interface
     static ngs::Timer tp("PETSc::SNES::Solve - PETSc");
     RegionTimer rt(tt);
 
+    step_stats.SetSize0(); jac_pending = false;
+    x_valid = f_valid = lin_valid = false;
+    if (!jac_persists)
+      { have_jac = false; }
+
     jac_mat->GetRowMap()->NGs2PETSc(sol, sol_vec);
     jac_mat->GetRowMap()->NGs2PETSc(rhs, rhs_vec);
 
@@ -191,13 +467,14 @@ namespace ngs_petsc_interface
 
     {
       RegionTimer rt(tp);
-      SNESSolve(GetSNES(), rhs_vec, sol_vec);
+      // start the TaskManager once, not in every evaluation
+      ngs::RunWithTaskManager([&] () { SNESSolve(GetSNES(), rhs_vec, sol_vec); });
     }
 
     // cout << "SNES SOL: " << sol_vec << endl;
     // VecView(sol_vec, PETSC_VIEWER_STDOUT_WORLD);
 
-    jac_mat->GetRowMap()->PETSc2NGs(sol, sol_vec);
+    jac_mat->GetRowMap()->PETSc2NGs(sol, sol_vec, ngs::CUMULATED);
 
   }
 
@@ -213,14 +490,84 @@ namespace ngs_petsc_interface
     return jac_mat->GetColMap();
   } // PETScSNES :: GetColMap
 
+  bool PETScSNES :: IsCachedState (PETScVec x)
+  {
+    if (!x_valid)
+      { return false; }
+    PetscObjectId id; PetscObjectGetId((PetscObject)x, &id);
+    PetscObjectState state; PetscObjectStateGet((PetscObject)x, &state);
+    if ( (id == x_id) && (state == x_state) )
+      { return true; }
+    // a copy of the cached state (newtonls: VecCopy(W, X) after the line search) - much cheaper than a new linearization
+    PetscBool equal; VecEqual(x, x_cache, &equal);
+    if (equal) {
+      x_id = id; x_state = state;
+      return true;
+    }
+    return false;
+  } // PETScSNES::IsCachedState
+
+
+  void PETScSNES :: SetCachedState (PETScVec x)
+  {
+    jac_mat->GetRowMap()->PETSc2NGs(*row_vec, x, ngs::CUMULATED);
+    PetscObjectGetId((PetscObject)x, &x_id);
+    PetscObjectStateGet((PetscObject)x, &x_state);
+    VecCopy(x, x_cache);
+    x_valid = true;
+    f_valid = lin_valid = false;
+  } // PETScSNES::SetCachedState
+
+
+  bool PETScSNES :: UseFused () const
+  {
+    // FLAT: the matrix we would assemble into is the jacobi matrix, which has to stay when it is lagged
+    PETScInt snes_lag; SNESGetLagJacobian(GetSNES(), &snes_lag);
+    return fused && (!blf->UsesEliminateInternal()) && (!HasSkeletonIntegrators(*blf)) && (!HasCoDimIntegrators(*blf)) &&
+      ( (mode == APPLY) || (mode == CONVERT) || ( (mode == FLAT) && (jac_lag == 1) && (snes_lag == 1) ) );
+  } // PETScSNES::UseFused
+
+
+  void PETScSNES :: EvaluateFused (LocalHeap & lh)
+  {
+    static ngs::Timer t("PETSc::SNES::EvaluateFused"); ngs::RegionTimer rt(t);
+
+    if (mode == APPLY)
+      { cached_lin->SetLinearization(*row_vec, lh, col_vec.get()); }
+    else {
+      // assemble into the (local) matrix of blf, same pattern as AssembleLinearization
+      auto mat = blf->GetMatrixPtr();
+      if (auto parmat = dynamic_pointer_cast<ngs::ParallelMatrix>(mat))
+	{ mat = parmat->GetMatrix(); }
+      mat->AsVector() = 0.0;
+      IterateLinearization(*blf, *row_vec, col_vec.get(), lh,
+			   [&] (ngs::ElementId ei, FlatArray<int> dnums, ngs::FlatMatrix<double> elmat) {
+			     mat->AddElementMatrix(dnums, dnums, elmat, false);
+			   });
+    }
+    lin_valid = true;
+  } // PETScSNES::EvaluateFused
+
+
   PetscErrorCode PETScSNES :: EvaluateF (SNES snes, PETScVec x, PETScVec f, void* ctx)
   {
+    static ngs::Timer t("PETSc::SNES::EvaluateF"); ngs::RegionTimer rt(t);
+
     auto& self = *( (PETScSNES*) ctx);
-    HeapReset hr(*self.use_lh);
 
-    self.jac_mat->GetRowMap()->PETSc2NGs(*self.row_vec, x);
+    // x has not changed since the last evaluation (e.g. after a line search)
+    if ( self.f_valid && self.IsCachedState(x) )
+      { return VecCopy(self.f_cache, f); }
 
-    self.blf->ApplyMatrix(*self.row_vec, *self.col_vec, *self.use_lh);
+    self.SetCachedState(x);
+
+    bool fuse = self.UseFused();
+    self.RunWithHeap([&] (LocalHeap & lh) {
+	if (fuse)
+	  { self.EvaluateFused(lh); }
+	else
+	  { self.blf->ApplyMatrix(*self.row_vec, *self.col_vec, lh); }
+      });
 
     self.jac_mat->GetColMap()->NGs2PETSc(*self.col_vec, f);
 
@@ -230,30 +577,107 @@ namespace ngs_petsc_interface
     // cout << endl << "F(x): " << endl;
     // VecView(f, PETSC_VIEWER_STDOUT_WORLD);
 
+    auto ierr = VecCopy(f, self.f_cache); CHKERRQ(ierr);
+    self.f_valid = true;
+
     return PetscErrorCode(0);
   }
 
 
   PetscErrorCode PETScSNES :: EvaluateJac (SNES snes, PETScVec x, PETScMat A, PETScMat B, void* ctx)
   {
+    static ngs::Timer t("PETSc::SNES::EvaluateJac");
+    static ngs::Timer ta("PETSc::SNES::EvaluateJac - assemble");
+    ngs::RegionTimer rt(t);
+
     auto& self = *( (PETScSNES*) ctx);
-    HeapReset hr(*self.use_lh);
+    double t0 = ngs::WallTime();
     
     if (A && A != B) {
       // this resets the status of A
       auto ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
       ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
     }
-    if(B != self.jac_mat->GetPETScMat())
+    if(B != self.pc_mat->GetPETScMat())
       { throw Exception("Mismatching matrices in PETScSNES::EvaluateJac!"); }
 
-    self.jac_mat->GetRowMap()->PETSc2NGs(*self.lin_vec, x);
+    PETScInt it; SNESGetIterationNumber(snes, &it);
+    bool assemble = (!self.have_jac) || ( (self.jac_lag > 0) && (it % self.jac_lag == 0) );
+
+    // usually F was just evaluated at x, then x is already converted (and maybe even linearized at)
+    if (!self.IsCachedState(x))
+      { self.SetCachedState(x); }
+    auto & lin = *self.row_vec;
+
+    switch(self.mode) {
+    case(APPLY) : {
+      if (!self.lin_valid)
+	{ self.RunWithHeap([&] (LocalHeap & lh) { self.cached_lin->SetLinearization(lin, lh); }); }
+      break;
+    }
+    case(MFFD) : {
+      // SNES already has F(x) - rhs, no need to evaluate it again
+      PETScVec f, rhs;
+      auto ierr = SNESGetFunction(snes, &f, NULL, NULL); CHKERRQ(ierr);
+      ierr = SNESGetRhs(snes, &rhs); CHKERRQ(ierr);
+      self.jac_mat->GetColMap()->PETSc2NGs(*self.f_vec, f, ngs::DISTRIBUTED);
+      if (rhs != NULL)
+	{ self.jac_mat->GetColMap()->AddPETSc2NGs(1.0, *self.f_vec, rhs); }
+      self.fd_lin->SetLinearization(lin, *self.f_vec);
+      break;
+    }
+    default : {
+      if (assemble) {
+	ngs::RegionTimer rta(ta);
+	// do not re-allocate matrix !
+	if (!self.lin_valid)
+	  { self.RunWithHeap([&] (LocalHeap & lh) { self.blf->AssembleLinearization (lin, lh, false); }); }
+	self.jac_mat->UpdateValues();
+	// a shell matrix has no pattern PETSc could compare, only tell it the values changed
+	if (self.mode == FLAT)
+	  { PetscObjectStateIncrease((PetscObject)self.jac_mat->GetPETScMat()); }
+      }
+      break;
+    }
+    }
+
+    if ( assemble && (self.pc_blf != nullptr) ) {
+      ngs::RegionTimer rta(ta);
+      self.RunWithHeap([&] (LocalHeap & lh) { self.pc_blf->AssembleLinearization (lin, lh, false); });
+      self.pc_mat->UpdateValues();
+    }
 
-    // do not re-allocate matrix !
-    if (self.mode != APPLY)
-      { self.blf->AssembleLinearization (*self.lin_vec, *self.use_lh, false); }
+    // a lagged B keeps its state, so PETSc does not set up the PC again either
+    self.have_jac |= assemble;
 
-    self.jac_mat->UpdateValues();
+    self.cur_step.it = it;
+    self.cur_step.assembled = assemble;
+    self.cur_step.t_jac = ngs::WallTime() - t0;
+    self.jac_pending = true;
+
+    return PetscErrorCode(0);
+  }
+
+
+  PetscErrorCode PETScSNES :: KSPPreSolve (KSP ksp, PETScVec b, PETScVec x, void* ctx)
+  {
+    static ngs::Timer t("PETSc::SNES::KSPPreSolve - setup"); ngs::RegionTimer rt(t);
+
+    auto& self = *( (PETScSNES*) ctx);
+
+    StepStats step;
+    if (self.jac_pending)
+      { step = self.cur_step; }
+    else // jacobian was lagged by SNES itself
+      { SNESGetIterationNumber(self.GetSNES(), &step.it); }
+
+    // KSPSolve sets up after this hook, do it here so we can time it; the calls in KSPSolve are then no-ops
+    double t0 = ngs::WallTime();
+    auto ierr = KSPSetUp(ksp); CHKERRQ(ierr);
+    ierr = KSPSetUpOnBlocks(ksp); CHKERRQ(ierr);
+    step.t_setup = ngs::WallTime() - t0;
+    self.step_stats.Append(step);
+    self.jac_pending = false;
 
     return PetscErrorCode(0);
   }
@@ -315,26 +739,33 @@ namespace ngs_petsc_interface {
     py::enum_<PETScSNES::JACOBI_MAT_MODE>
       (snes, "JACOBI_MAT_MODE", docu_string(R"raw_string(
 How the jacobi matrix should be implemented:
-APPLY   ... Do not assemble jacobi mat (use ApplyLinearization)
+APPLY   ... Do not assemble jacobi mat, keep the element matrices of each Newton step and apply them
 FLAT    ... Assemble Jacobi matrix, but only wrap it to PETSc
-CONVERT ... Assemble Jacobi matrix, and convert it to a PETSc matrix)raw_string"))
+CONVERT ... Assemble Jacobi matrix, and convert it to a PETSc matrix
+MFFD    ... Do not assemble jacobi mat, finite differences of F around the current residual
+
+For APPLY and MFFD, give a (cheaper) "pc_blf" to build the preconditioner from.)raw_string"))
       .value("APPLY"  , PETScSNES::JACOBI_MAT_MODE::APPLY)
       .value("FLAT"   , PETScSNES::JACOBI_MAT_MODE::FLAT)
       .value("CONVERT", PETScSNES::JACOBI_MAT_MODE::CONVERT)
+      .value("MFFD"   , PETScSNES::JACOBI_MAT_MODE::MFFD)
       .export_values()
       ;
 
     snes.def(py::init<>
 	     ([&] (shared_ptr<ngs::BilinearForm> blf, string name, bool finalize,
-		   PETScSNES::JACOBI_MAT_MODE mode, py::dict petsc_options) {
+		   PETScSNES::JACOBI_MAT_MODE mode, py::dict petsc_options, shared_ptr<ngs::BilinearForm> pc_blf,
+		   bool fused) {
 	       auto opt_array = Dict2SA(petsc_options);
-	       auto snes = make_shared<PETScSNES>(blf, opt_array, name, make_shared<LocalHeap>(10*1024*1024), mode);
+	       auto snes = make_shared<PETScSNES>(blf, opt_array, name, nullptr, mode, pc_blf);
+	       snes->SetFused(fused);
 	       if (finalize)
 		 { snes->Finalize(); }
 	       return snes;
 	     }),
 	     py::arg("blf"), py::arg("name") = string(""), py::arg("finalize") = true,
-	     py::arg("mode") = PETScSNES::JACOBI_MAT_MODE::FLAT, py::arg("petsc_options") = py::dict()
+	     py::arg("mode") = PETScSNES::JACOBI_MAT_MODE::FLAT, py::arg("petsc_options") = py::dict(),
+	     py::arg("pc_blf") = nullptr, py::arg("fused") = false
 	     );
     snes.def("Finalize", [](shared_ptr<PETScSNES> & snes) { snes->Finalize(); });
     snes.def("Solve", [](shared_ptr<PETScSNES> & snes, shared_ptr<ngs::BaseVector> sol, shared_ptr<ngs::BaseVector> rhs) {
@@ -346,6 +777,35 @@ CONVERT ... Assemble Jacobi matrix, and convert it to a PETSc matrix)raw_string"
     snes.def("GetKSP", [](shared_ptr<PETScSNES> & snes) -> shared_ptr<PETScKSP> {
 	return snes->GetKSP();
       });
+    snes.def("SetLagging", [](shared_ptr<PETScSNES> & snes, int jac_lag, int pc_lag, bool persists) {
+	snes->SetLagging(jac_lag, pc_lag, persists);
+      }, py::arg("jac_lag") = 1, py::arg("pc_lag") = 1, py::arg("persists") = false, docu_string(R"raw_string(
+Re-assemble the jacobi matrix (and the one from pc_blf) only every jac_lag-th Newton step,
+rebuild the preconditioner only every pc_lag-th Newton step. -1 means never (after the first step).
+Matrix-free jacobians (APPLY, MFFD) always move to the new linearization point.
+With persists=True, lagged matrices and preconditioner are kept from one Solve to the next,
+otherwise every Solve assembles them again in its first step.)raw_string"));
+    snes.def_property_readonly("heap_size", [](shared_ptr<PETScSNES> & snes) {
+	return snes->GetHeapSizePerThread();
+      }, "LocalHeap size per thread (grows automatically)");
+    snes.def_property_readonly("results", [](shared_ptr<PETScSNES> & snes) -> py::dict {
+	auto results = py::dict();
+	SNESConvergedReason conv_r; SNESGetConvergedReason(snes->GetSNES(), &conv_r);
+	results["conv_r"] = py::str(name_reason(conv_r));
+	PETScInt nits; SNESGetIterationNumber(snes->GetSNES(), &nits);
+	results["nits"] = py::int_(nits);
+	// per Newton step
+	auto py_ass = py::list(), py_tj = py::list(), py_ts = py::list();
+	for (const auto & step : snes->GetStepStats()) {
+	  py_ass.append(py::bool_(step.assembled));
+	  py_tj.append(py::float_(step.t_jac));
+	  py_ts.append(py::float_(step.t_setup));
+	}
+	results["jac_assembled"] = py_ass;
+	results["t_jac"] = py_tj;
+	results["t_setup"] = py_ts;
+	return results;
+      });
   //   snes.def("SetVIBounds", [] (shared_ptr<PETScSNES> & snes, shared_ptr<ngs::BaseVector> low, shared_ptr<ngs::BaseVector> up)
   // 	     {
   // 	       snes->SetVIBounds(low, up);
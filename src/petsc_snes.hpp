@@ -4,6 +4,72 @@
 namespace ngs_petsc_interface
 {
 
+  /**
+     Exact application of the linearization of a (nonlinear) BilinearForm.
+     Element matrices are computed once per linearization point and kept, a product only
+     gathers, multiplies and scatters. Needs as much memory as the element matrices.
+   **/
+  class CachedLinearization : public ngs::BaseMatrix
+  {
+  public:
+    CachedLinearization (shared_ptr<ngs::BilinearForm> _blf);
+
+    /** compute and store the element matrices of F'(lin), in the same loop also res = F(lin) if res is given **/
+    void SetLinearization (const ngs::BaseVector & lin, LocalHeap & lh, ngs::BaseVector * res = nullptr);
+
+    virtual int VHeight () const override { return blf->GetTestSpace()->GetNDof(); }
+    virtual int VWidth () const override { return blf->GetTrialSpace()->GetNDof(); }
+    virtual ngs::AutoVector CreateRowVector () const override { return blf->CreateRowVector(); }
+    virtual ngs::AutoVector CreateColVector () const override { return blf->CreateColVector(); }
+
+    virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override
+    { y = 0.0; MultAdd(1.0, x, y); }
+    virtual void MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const override;
+
+  protected:
+    shared_ptr<ngs::BilinearForm> blf;
+    int dim;
+    size_t el_first[2];       // first cached element of VOL and BND
+    Array<size_t> dof_first;  // element -> first entry in dofs
+    Array<size_t> mat_first;  // element -> first entry in vals
+    Array<int> dofs;
+    Array<double> vals;       // element matrices, row-major
+  };
+
+
+  /**
+     Finite difference approximation of the linearization,
+       F'(u) x ~ ( F(u + h x) - F(u) ) / h,   h = err sqrt(1 + |u|) / |x|
+     F(u) is not computed here, it is handed in (usually the residual SNES already has).
+   **/
+  class FDLinearization : public ngs::BaseMatrix
+  {
+  public:
+    /** run_with_heap(f) calls f(lh), again with a larger heap if it overflows (see PETScSNES::RunWithHeap) **/
+    using HeapRunner = std::function<void(const std::function<void(LocalHeap&)> &)>;
+    FDLinearization (shared_ptr<ngs::BilinearForm> _blf, HeapRunner _run_with_heap, double _err = 1.5e-8);
+
+    /** lin must be cumulated, f_lin = F(lin) can be distributed **/
+    void SetLinearization (const ngs::BaseVector & lin, const ngs::BaseVector & f_lin);
+
+    virtual int VHeight () const override { return blf->GetTestSpace()->GetNDof(); }
+    virtual int VWidth () const override { return blf->GetTrialSpace()->GetNDof(); }
+    virtual ngs::AutoVector CreateRowVector () const override { return blf->CreateRowVector(); }
+    virtual ngs::AutoVector CreateColVector () const override { return blf->CreateColVector(); }
+
+    virtual void Mult (const ngs::BaseVector & x, ngs::BaseVector & y) const override
+    { y = 0.0; MultAdd(1.0, x, y); }
+    virtual void MultAdd (double scal, const ngs::BaseVector & x, ngs::BaseVector & y) const override;
+
+  protected:
+    shared_ptr<ngs::BilinearForm> blf;
+    HeapRunner run_with_heap;
+    double err;
+    double lin_norm = 0;
+    shared_ptr<ngs::BaseVector> u, fu, upert, fpert;
+  };
+
+
   /**
      Solves F(u) = 0
    **/
@@ -11,18 +77,24 @@ namespace ngs_petsc_interface
   {
   public:
 
-    enum JACOBI_MAT_MODE : uint8_t { APPLY = 0,       // Do not assemble jacobi mat (use ApplyLinearization)
+    enum JACOBI_MAT_MODE : uint8_t { APPLY = 0,       // Do not assemble jacobi mat, apply cached element matrices (see CachedLinearization)
 				     FLAT = 1,        // Assemble Jacobi matrix, but only wrap it to PETSc
-				     CONVERT = 2 };   // Assemble Jacobi matrix, and convert it to a PETSc matrix
+				     CONVERT = 2,     // Assemble Jacobi matrix, and convert it to a PETSc matrix
+				     MFFD = 3 };      // Do not assemble jacobi mat, finite differences of F (see FDLinearization)
 
+    /**
+       _pc_blf: if given, its linearization is assembled and converted to PETSc, and the PC
+                is built from it instead of the jacobi matrix (needed for APPLY/MFFD unless no PC is used)
+     **/
     PETScSNES (shared_ptr<ngs::BilinearForm> _blf, FlatArray<string> _opts, string _name = "",
-	       shared_ptr<ngs::LocalHeap> _lh = nullptr, JACOBI_MAT_MODE _jac_mode = FLAT);
+	       shared_ptr<ngs::LocalHeap> _lh = nullptr, JACOBI_MAT_MODE _jac_mode = FLAT,
+	       shared_ptr<ngs::BilinearForm> _pc_blf = nullptr);
 
     ~PETScSNES ();
 
     void Finalize ();
     
-    INLINE SNES& GetSNES () { return snes; }
+    INLINE SNES& GetSNES () { return snes.Get(); }
     INLINE SNES GetSNES () const { return snes; }
 
     INLINE shared_ptr<PETScKSP> GetKSP () const { return ksp; }
@@ -39,6 +111,45 @@ namespace ngs_petsc_interface
     // A = F'(x), B is the matrix used to build the PC used for the linear solve with A
     static PetscErrorCode EvaluateJac (SNES snes, PETScVec x, PETScMat A, PETScMat B, void* ctx);
 
+    // called by the KSP before it is set up, sets it (and its PC) up and records the step stats
+    static PetscErrorCode KSPPreSolve (KSP ksp, PETScVec b, PETScVec x, void* ctx);
+
+    /**
+       Lagging:
+	 jac_lag: assembled matrices (the jacobi mat for FLAT/CONVERT, and the one from pc_blf) are only re-assembled
+	          every jac_lag-th Newton step, -1 for never (after the first step). Matrix-free jacobians always
+		  move on to the new linearization point.
+	 pc_lag:  the PC is only rebuilt every pc_lag-th Newton step, -1 for never
+	 persists: keep lagged matrices and PC from one Solve to the next, by default every Solve
+	           starts with a fresh jacobian and PC
+     **/
+    void SetLagging (int _jac_lag, int _pc_lag, bool _persists = false);
+
+    /**
+       Fused evaluation: every evaluation of F also computes the linearization in the same loop over the elements,
+       a following jacobian evaluation at the same x does not loop over the elements again. Pays off if most
+       F evaluations are followed by a jacobian (e.g. basic line search). Not used for MFFD, with static condensation,
+       and in FLAT mode with lagging.
+     **/
+    void SetFused (bool _fused) { fused = _fused; }
+
+    /**
+       Element loops run in the NGSolve TaskManager, the LocalHeap is split among its threads.
+       When a loop overflows the heap, it is repeated with a new one twice the size. A heap handed
+       in to the constructor is not changed, we switch to our own one then.
+     **/
+    size_t GetHeapSizePerThread () const { return heap_per_thread; }
+
+    /** what happened in one Newton step of the last Solve **/
+    struct StepStats
+    {
+      int it = 0;
+      bool assembled = false; // jacobi/PC mat was re-assembled
+      double t_jac = 0;       // seconds in EvaluateJac
+      double t_setup = 0;     // seconds in KSPSetUp + KSPSetUpOnBlocks before the linear solve
+    };
+    FlatArray<StepStats> GetStepStats () const { return step_stats; }
+
     // static PetscErrorCode CreateDMVec (DM dm, PETScVec* pv);
 
     /** Misc. configuration that connot be done by flags **/
@@ -48,12 +159,40 @@ namespace ngs_petsc_interface
     shared_ptr<ngs::BilinearForm> blf;
     shared_ptr<LocalHeap> use_lh;
     JACOBI_MAT_MODE mode;
-    SNES snes;
+    PETScHandle<SNES> snes;
     shared_ptr<PETScKSP> ksp;
-    PETScVec func_vec, sol_vec, rhs_vec;
+    PETScHandle<PETScVec> func_vec, sol_vec, rhs_vec;
     shared_ptr<PETScBaseMatrix> jac_mat;
-    shared_ptr<ngs::BaseVector> row_vec, col_vec, lin_vec;
+    shared_ptr<ngs::BilinearForm> pc_blf;
+    shared_ptr<PETScBaseMatrix> pc_mat;      // the PC is built from this, jac_mat if there is no pc_blf
+    shared_ptr<CachedLinearization> cached_lin; // only APPLY
+    shared_ptr<FDLinearization> fd_lin;          // only MFFD
+    shared_ptr<ngs::BaseVector> row_vec, col_vec, lin_vec, f_vec;
+    int jac_lag = 1;
+    bool jac_persists = false;   // have_jac survives Solve
+    bool have_jac = false;       // assembled at least once at an actual Newton iterate
+    Array<StepStats> step_stats;
+    StepStats cur_step;
+    bool jac_pending = false;    // cur_step was filled by EvaluateJac, but the linear solve has not started yet
     // DM petsc_dm;
+
+    /**
+       row_vec holds x converted to NGSolve for some PETSc-Vec x, keyed by the object id and state of x.
+       If the key misses, the values are compared (line searches evaluate F at W, then copy W to X).
+    **/
+    bool IsCachedState (PETScVec x);
+    void SetCachedState (PETScVec x);
+    bool UseFused () const;
+    void EvaluateFused (LocalHeap & lh); // at row_vec, residual to col_vec
+    template<class TFUNC> void RunWithHeap (TFUNC f); // f(lh), in the TaskManager, again with a larger heap on overflow
+    void GrowHeap (size_t per_thread);
+    size_t heap_per_thread = 0;
+    bool fused = false;
+    PETScHandle<PETScVec> f_cache;   // F(x) for the cached state
+    PETScHandle<PETScVec> x_cache;   // the cached state itself
+    PetscObjectId x_id = 0;
+    PetscObjectState x_state = 0;
+    bool x_valid = false, f_valid = false, lin_valid = false;
   };
 
 } // namespace ngs_petsc_interface
@@ -11,6 +11,8 @@ typedef struct _p_IS *IS;
 typedef struct _n_PetscOptions *PetscOptions;
 typedef struct _p_ISLocalToGlobalMapping* ISLocalToGlobalMapping;
 typedef struct _p_MatNullSpace* MatNullSpace;
+typedef struct _p_PetscSF* PetscSF;
+typedef struct _p_PetscObject* PetscObject;
 typedef const char *MatType;
 typedef const char *PCType;
 
@@ -25,6 +27,8 @@ namespace ngs_petsc_interface
 
   using PETScVec = ::Vec;
 
+  using PETScSF = ::PetscSF;
+
   using PETScMat = ::Mat;
   using PETScMatType = ::MatType;
 
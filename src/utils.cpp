@@ -4,6 +4,10 @@
 
 #include <python_ngstd.hpp> 
 
+#include <set>
+#include <map>
+#include <mutex>
+
 namespace ngs_petsc_interface
 {
 
@@ -23,7 +27,101 @@ namespace ngs_petsc_interface
   }
 
 
-  void FinalizePETSc () { PetscFinalize(); }
+  /** all live handles, allocated once and never freed so handles in static objects can still deregister **/
+  INLINE std::set<PETScHandleBase*> & GetHandleRegistry ()
+  {
+    static auto * registry = new std::set<PETScHandleBase*>();
+    return *registry;
+  }
+
+  INLINE std::mutex & GetHandleRegistryMutex ()
+  {
+    static auto * mutex = new std::mutex();
+    return *mutex;
+  }
+
+
+  PETScHandleBase :: PETScHandleBase ()
+  {
+    std::lock_guard<std::mutex> guard(GetHandleRegistryMutex());
+    GetHandleRegistry().insert(this);
+  }
+
+
+  PETScHandleBase :: ~PETScHandleBase ()
+  {
+    std::lock_guard<std::mutex> guard(GetHandleRegistryMutex());
+    GetHandleRegistry().erase(this);
+  }
+
+
+  INLINE bool PETScIsAlive ()
+  {
+    PetscBool init, fin;
+    PetscInitialized(&init); PetscFinalized(&fin);
+    return init && !fin;
+  }
+
+
+  void ReferencePETScObject (PetscObject obj)
+  {
+    if ( (obj != NULL) && PETScIsAlive() )
+      { PetscObjectReference(obj); }
+  }
+
+
+  void DestroyPETScObject (PetscObject * obj)
+  {
+    if ( (*obj != NULL) && PETScIsAlive() )
+      { PetscObjectDestroy(obj); }
+    *obj = NULL;
+  }
+
+
+  size_t GetNumLivePETScObjects ()
+  {
+    std::lock_guard<std::mutex> guard(GetHandleRegistryMutex());
+    size_t cnt = 0;
+    for (auto handle : GetHandleRegistry())
+      if (handle->GetPETScObject() != NULL)
+	{ cnt++; }
+    return cnt;
+  }
+
+
+  void FinalizePETSc ()
+  {
+    if (!PETScIsAlive()) // (atexit calls this again)
+      { return; }
+
+    Array<PETScHandleBase*> live;
+    {
+      std::lock_guard<std::mutex> guard(GetHandleRegistryMutex());
+      for (auto handle : GetHandleRegistry())
+	if (handle->GetPETScObject() != NULL)
+	  { live.Append(handle); }
+    }
+
+    // objects still owned at this point belong to NGSolve-side objects that are still alive (e.g. held by python)
+    PetscBool report = PETSC_FALSE;
+    PetscOptionsHasName(NULL, NULL, "-ngs_petsc_report_leaks", &report);
+    if (report) {
+      std::map<string, int> cnt;
+      for (auto handle : live) {
+	const char * cname; PetscObjectGetClassName(handle->GetPETScObject(), &cname);
+	cnt[string(cname)]++;
+      }
+      PetscPrintf(PETSC_COMM_WORLD, "ngs_petsc: %d PETSc objects still owned at Finalize\n", int(live.Size()));
+      for (auto & [cname, num] : cnt)
+	{ PetscPrintf(PETSC_COMM_WORLD, "   %s : %d\n", cname.c_str(), num); }
+    }
+
+    // release them while PETSc is still up, the handles are only emptied and destroyed later on
+    for (auto handle : live)
+      { handle->Release(); }
+
+    PetscFinalize();
+  }
 
 
   string GetDefaultId ()
@@ -81,6 +179,12 @@ namespace ngs_petsc_interface
 	FinalizePETSc();
       });
 
+
+    m.def("NumLivePETScObjects", []() { return GetNumLivePETScObjects(); }, docu_string(R"raw_string(
+Number of PETSc objects currently owned by the interface (matrices, vectors, solvers, ...).
+Should stay constant when objects are rebuilt in a loop. Run with -ngs_petsc_report_leaks to get
+a list of the objects that are still owned in Finalize.)raw_string"));
+
   }
 
 
@@ -18,6 +18,70 @@ namespace ngs_petsc_interface
   void FinalizePETSc ();
 
 
+  /** Reference-counting of PETSc objects, both are no-ops for NULL and after PetscFinalize **/
+  void ReferencePETScObject (PetscObject obj);
+  void DestroyPETScObject (PetscObject * obj);
+
+
+  /** Base for PETScHandle, keeps track of all handles so FinalizePETSc can release
+      their objects while PETSc is still alive **/
+  class PETScHandleBase
+  {
+  public:
+    PETScHandleBase ();
+    PETScHandleBase (const PETScHandleBase & other) : PETScHandleBase() { ; }
+    virtual ~PETScHandleBase ();
+    PETScHandleBase & operator= (const PETScHandleBase & other) { return *this; }
+    virtual PetscObject GetPETScObject () const = 0;
+    virtual void Release () = 0;
+  };
+
+
+  /** Owns one reference to a PETSc object. The object is destroyed together with the handle,
+      or in FinalizePETSc if that comes first. Create objects into Get(), e.g. MatCreate(comm, &mat.Get()) **/
+  template<class T>
+  class PETScHandle : public PETScHandleBase
+  {
+  public:
+    PETScHandle (T _obj = NULL) : obj(_obj) { ; }
+    PETScHandle (const PETScHandle<T> & other) : obj(other.obj) { ReferencePETScObject((PetscObject)obj); }
+    ~PETScHandle () { Release(); }
+
+    /** takes over the reference to _obj (if we already hold _obj, that reference is dropped) **/
+    PETScHandle<T> & operator= (T _obj)
+    {
+      if (_obj != obj)
+	{ Release(); obj = _obj; }
+      else
+	{ DestroyPETScObject((PetscObject*)&_obj); }
+      return *this;
+    }
+
+    PETScHandle<T> & operator= (const PETScHandle<T> & other)
+    {
+      if (other.obj != obj) {
+	Release(); obj = other.obj;
+	ReferencePETScObject((PetscObject)obj);
+      }
+      return *this;
+    }
+
+    INLINE operator T () const { return obj; }
+    INLINE T & Get () { return obj; }
+    INLINE T Get () const { return obj; }
+
+    virtual PetscObject GetPETScObject () const override { return (PetscObject)obj; }
+    virtual void Release () override { DestroyPETScObject((PetscObject*)&obj); }
+
+  protected:
+    T obj;
+  };
+
+
+  /** number of handles that currently hold a PETSc object **/
+  size_t GetNumLivePETScObjects ();
+
+
 } // ngs_petsc_interface
 
 #endif